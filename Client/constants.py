@@ -6,8 +6,12 @@ WRONG_TURN = "WT"
 INVALID_GUESS = "IG"
 WIN_MSG = "WIN"
 LOST_MSG = "LOST"
+DRAW_MSG = "DRAW"
 ENDGAME_MSG = "EG"
 UR_TURN = "UT"
 OPP_TURN = "OT"
 GAME_START = "SG"
 WRONG_FORMAT = "WF"
+INVALID_VARIANT = "IV"
+HEARTBEAT_REQUEST = "HB\n"
+HEARTBEAT_PREFIX = "HB"
@@ -9,6 +9,7 @@ from constants import *
 
 # Constants
 BUFFER_SIZE = 1024
+DEFAULT_PING_INTERVAL = 3  # Seconds between PINGs until the server offers a longer heartbeat
 
 # Global Variables
 client_socket = None
@@ -39,6 +40,7 @@ class GameClient:
         self.chat_display = None
         self.send_button = None
         self.opponent_label = None
+        self.ping_interval = DEFAULT_PING_INTERVAL
 
     def start(self):
         print("[DEBUG] Starting client...")
@@ -82,6 +84,7 @@ class GameClient:
                     raise ValueError(f"Unexpected response from server: {initial_message}")
                 else:
                     print("[DEBUG] SUCCESSFUL_CONNECTION received.")
+                    client_socket.send(HEARTBEAT_REQUEST.encode('utf-8'))
             else:
                 raise TimeoutError("No response from server within the timeout period.")
 
@@ -212,6 +215,8 @@ class GameClient:
             self._update_chat("Congratulations! You won!")
         elif message == LOST_MSG:  # LOST
             self._update_chat("You lost. Better luck next time!")
+        elif message == DRAW_MSG:  # DRAW
+            self._update_chat("Turn limit reached. The game is a draw.")
         elif message == ENDGAME_MSG:  # EG
             self._update_chat("Game over. Enter a new nickname to play again.")
             self.send_button.configure(state='normal')  # Allow new nickname entry
@@ -222,6 +227,14 @@ class GameClient:
             client_socket.close()
         elif message == INVALID_GUESS:  # WF
             self._update_chat("Invalid guess format. Try again...")
+        elif message == INVALID_VARIANT:  # IV
+            self._update_chat("Unknown game variant. Use nickname#V<length>[R][H][T<turns>].")
+        elif message.startswith(HEARTBEAT_PREFIX):  # HB<seconds>
+            try:
+                self.ping_interval = int(message[len(HEARTBEAT_PREFIX):])
+                print(f"[DEBUG] Server accepts a PING every {self.ping_interval} seconds")
+            except ValueError:
+                print(f"[DEBUG] Malformed heartbeat offer: {message}")
         elif message.startswith("G"):  # Guess response
             self._handle_guess_response(message)
         else:
@@ -254,11 +267,11 @@ class GameClient:
         self.chat_display.configure(state='disabled')
         self.chat_display.yview(tk.END)
 
-    def _keep_alive(self, interval=3):
+    def _keep_alive(self):
         while not stop_event.is_set():
             try:
                 client_socket.send("PING".encode('utf-8'))
-                time.sleep(interval)
+                time.sleep(self.ping_interval)
             except Exception as e:
                 self.opponent_label.configure(text="Opponent (Disconnected)")
                 print(f"[DEBUG] Keep-alive error: {e}")
@@ -282,6 +295,8 @@ class GameClient:
             client_socket.connect((self.server_ip, self.server_port))
             print("[DEBUG] Reconnected successfully.")
             stop_event.clear()
+            self.ping_interval = DEFAULT_PING_INTERVAL
+            client_socket.send(HEARTBEAT_REQUEST.encode('utf-8'))
             if nickname:
                 print(f"[DEBUG] Resending nickname: {nickname}")
                 client_socket.send(nickname.encode('utf-8'))
@@ -0,0 +1,308 @@
+#include "admin_control.h"
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const int ADMIN_POLL_MS = 200;                                  // How often the admin thread checks for shutdown
+const auto ADMIN_REPLY_WAIT = std::chrono::milliseconds(200);
+const size_t ADMIN_MAX_LINE = 1024;
+
+static const char *ADMIN_HELP =
+    "sessions            list sessions\n"
+    "session <id>        show one session with its moves\n"
+    "kick <nickname>     disconnect a player\n"
+    "drain               stop accepting players, exit when the games are over\n"
+    "loglevel info|debug set the log level\n"
+    "timeout <seconds>   set the idle timeout\n"
+    "quit                close this admin connection\n";
+
+AdminControl::~AdminControl()
+{
+    if (admin.joinable())
+    {
+        stopping.store(true);
+        admin.join();
+    }
+
+    // Commands nobody will answer any more
+    for (AdminCommand *command : takeCommands())
+    {
+        delete command;
+    }
+
+    if (listenSocket != -1)
+    {
+        close(listenSocket);
+        if (endpoint.kind == ListenEndpoint::UNIX)
+        {
+            unlink(endpoint.address.c_str());
+        }
+    }
+    for (int fd : wakePair)
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+}
+
+bool AdminControl::start(const ListenEndpoint &adminEndpoint)
+{
+    endpoint = adminEndpoint;
+    listenSocket = openListenSocket(endpoint, 4);
+    if (listenSocket == -1)
+    {
+        return false;
+    }
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, wakePair) != 0)
+    {
+        return false;
+    }
+    fcntl(wakePair[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakePair[1], F_SETFL, O_NONBLOCK);
+
+    admin = std::thread(&AdminControl::adminLoop, this);
+    return true;
+}
+
+int AdminControl::wakeSocket() const
+{
+    return wakePair[0];
+}
+
+void AdminControl::clearWakeups()
+{
+    char buffer[64];
+    while (recv(wakePair[0], buffer, sizeof(buffer), 0) > 0)
+    {
+    }
+}
+
+std::vector<AdminCommand *> AdminControl::takeCommands()
+{
+    // Detach the whole list at once, then restore submission order
+    std::vector<AdminCommand *> commands;
+    for (AdminCommand *command = pending.exchange(nullptr, std::memory_order_acquire); command != nullptr; command = command->next)
+    {
+        commands.push_back(command);
+    }
+    std::reverse(commands.begin(), commands.end());
+    return commands;
+}
+
+void AdminControl::publish(std::shared_ptr<const ServerSnapshot> newSnapshot)
+{
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    snapshot = newSnapshot;
+}
+
+std::shared_ptr<const ServerSnapshot> AdminControl::latest() const
+{
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return snapshot;
+}
+
+/* ------------------------------------------------------------ ADMIN THREAD ---------------------------------------------------------------------*/
+
+void AdminControl::adminLoop()
+{
+    // One operator at a time, the game loop is never waited on for long
+    while (!stopping.load())
+    {
+        struct pollfd listening = {listenSocket, POLLIN, 0};
+        if (poll(&listening, 1, ADMIN_POLL_MS) <= 0)
+        {
+            continue;
+        }
+        int operatorSocket = accept(listenSocket, nullptr, nullptr);
+        if (operatorSocket == -1)
+        {
+            continue;
+        }
+
+#ifdef SO_PEERCRED
+        // Local operators must run as the server's user or root; unknown credentials are refused
+        struct ucred peer;
+        socklen_t length = sizeof(peer);
+        if (getsockopt(operatorSocket, SOL_SOCKET, SO_PEERCRED, &peer, &length) != 0 ||
+            (peer.uid != geteuid() && peer.uid != 0))
+        {
+            close(operatorSocket);
+            continue;
+        }
+#endif
+        fcntl(operatorSocket, F_SETFL, 0);
+        serveOperator(operatorSocket);
+        close(operatorSocket);
+    }
+}
+
+void AdminControl::serveOperator(int operatorSocket)
+{
+    std::string buffer;
+    char chunk[256];
+    while (!stopping.load())
+    {
+        struct pollfd readable = {operatorSocket, POLLIN, 0};
+        if (poll(&readable, 1, ADMIN_POLL_MS) <= 0)
+        {
+            continue;
+        }
+        ssize_t received = recv(operatorSocket, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+        {
+            return;
+        }
+        buffer.append(chunk, received);
+        if (buffer.size() > ADMIN_MAX_LINE && buffer.find('\n') == std::string::npos)
+        {
+            return;
+        }
+
+        size_t newline;
+        while ((newline = buffer.find('\n')) != std::string::npos)
+        {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (line == "quit")
+            {
+                return;
+            }
+
+            std::string answer = execute(line);
+            if (send(operatorSocket, answer.data(), answer.size(), MSG_NOSIGNAL) < 0)
+            {
+                return;
+            }
+        }
+    }
+}
+
+std::string AdminControl::execute(const std::string &line)
+{
+    std::istringstream words(line);
+    std::string command, argument;
+    words >> command >> argument;
+
+    if (command.empty())
+    {
+        return "";
+    }
+    if (command == "help")
+    {
+        return ADMIN_HELP;
+    }
+    if (command == "kick" && !argument.empty())
+    {
+        return submit(AdminCommandType::KICK, argument);
+    }
+    if (command == "drain")
+    {
+        return submit(AdminCommandType::DRAIN);
+    }
+    if (command == "loglevel" && (argument == "info" || argument == "debug"))
+    {
+        return submit(AdminCommandType::LOG_LEVEL, argument, argument == "debug" ? 1 : 0);
+    }
+    if (command == "timeout")
+    {
+        try
+        {
+            int seconds = std::stoi(argument);
+            if (seconds > 0)
+            {
+                return submit(AdminCommandType::IDLE_TIMEOUT, argument, seconds);
+            }
+        }
+        catch (const std::exception &)
+        {
+        }
+        return "error: timeout needs a positive number of seconds\n";
+    }
+
+    if (command != "sessions" && command != "session")
+    {
+        return "error: unknown command, try help\n";
+    }
+
+    // Reads are answered from a snapshot the game loop publishes on request
+    std::string refreshed = submit(AdminCommandType::SNAPSHOT);
+    if (!refreshed.empty())
+    {
+        return refreshed;
+    }
+    std::shared_ptr<const ServerSnapshot> state = latest();
+
+    std::ostringstream out;
+    if (command == "sessions")
+    {
+        out << "connections " << state->connections << ", players " << state->players << ", throttled " << state->throttled
+            << ", sessions " << state->sessions.size() << ", idle timeout " << state->idleTimeout << "s"
+            << (state->draining ? ", draining" : "") << "\n";
+        for (const SessionSnapshot &session : state->sessions)
+        {
+            out << session.id << " " << session.variant << " "
+                << (session.nickname1.empty() ? "-" : session.nickname1) << (session.player1 == -1 ? " (away)" : "") << " vs "
+                << (session.nickname2.empty() ? "-" : session.nickname2) << (session.player2 == -1 && !session.nickname2.empty() ? " (away)" : "")
+                << ", " << session.turnsTaken << " turns" << (session.reserved ? ", seat held" : "") << "\n";
+        }
+        return out.str();
+    }
+
+    for (const SessionSnapshot &session : state->sessions)
+    {
+        if (std::to_string(session.id) != argument)
+        {
+            continue;
+        }
+        out << "session " << session.id << " " << session.variant << "\n"
+            << "player1 " << session.nickname1 << " socket " << session.player1 << "\n"
+            << "player2 " << session.nickname2 << " socket " << session.player2 << "\n"
+            << "turns " << session.turnsTaken << (session.reserved ? ", seat held" : "") << "\n";
+        for (const std::string &move : session.moves)
+        {
+            out << "  " << move;
+        }
+        return out.str();
+    }
+    return "error: no session " + argument + "\n";
+}
+
+std::string AdminControl::submit(AdminCommandType type, const std::string &argument, int value)
+{
+    AdminCommand *command = new AdminCommand();
+    command->type = type;
+    command->argument = argument;
+    command->value = value;
+    std::future<std::string> answer = command->reply.get_future();
+
+    // Lock-free push; the game loop takes the whole list in one exchange
+    AdminCommand *head = pending.load(std::memory_order_relaxed);
+    do
+    {
+        command->next = head;
+    } while (!pending.compare_exchange_weak(head, command, std::memory_order_release, std::memory_order_relaxed));
+
+    char wake = 1;
+    send(wakePair[1], &wake, 1, MSG_NOSIGNAL);
+
+    // The game loop owns the command now and frees it after replying
+    while (answer.wait_for(ADMIN_REPLY_WAIT) != std::future_status::ready)
+    {
+        if (stopping.load())
+        {
+            return "error: server is shutting down\n";
+        }
+    }
+    return answer.get();
+}
@@ -0,0 +1,93 @@
+#ifndef ADMIN_CONTROL_H
+#define ADMIN_CONTROL_H
+
+#include <atomic>
+#include <ctime>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "listeners.h"
+
+enum class AdminCommandType {
+    SNAPSHOT,       // Publish a fresh snapshot, answers are read from it
+    KICK,           // Disconnect the player with the nickname in argument
+    DRAIN,          // Stop accepting players, exit once the running games are over
+    LOG_LEVEL,      // Set the log level to value
+    IDLE_TIMEOUT    // Set USER_TIMEOUT to value seconds
+};
+
+// One operator request, owned by the admin thread until the game loop has answered it
+struct AdminCommand {
+    AdminCommandType type = AdminCommandType::SNAPSHOT;
+    std::string argument;
+    int value = 0;
+    std::promise<std::string> reply;
+    AdminCommand *next = nullptr;   // Link in the command queue
+};
+
+struct SessionSnapshot {
+    int id = 0;
+    std::string variant;
+    std::string nickname1;
+    std::string nickname2;
+    int player1 = -1;
+    int player2 = -1;
+    int turnsTaken = 0;
+    bool reserved = false;          // A dropped player's seat is being held
+    std::vector<std::string> moves;
+};
+
+// Read-only copy of the game loop's state, published on request
+struct ServerSnapshot {
+    time_t builtAt = 0;
+    size_t connections = 0;
+    size_t throttled = 0;
+    size_t players = 0;             // Connections that have set a nickname
+    bool draining = false;
+    int logLevel = 0;
+    int idleTimeout = 0;
+    std::vector<SessionSnapshot> sessions;
+};
+
+// Text interface for operators on its own socket and thread.
+// Commands are pushed onto a lock-free multi-producer queue that the game loop drains once per iteration;
+// the game loop wakes up through a socket pair and answers through snapshots and command replies.
+class AdminControl {
+public:
+    ~AdminControl();
+
+    // Listens on the endpoint and starts the admin thread, false if the endpoint cannot be opened
+    bool start(const ListenEndpoint &endpoint);
+
+    // Readable whenever commands are waiting, watched by the game loop
+    int wakeSocket() const;
+    void clearWakeups();
+
+    // Takes every queued command, oldest first. Game loop only.
+    std::vector<AdminCommand *> takeCommands();
+
+    void publish(std::shared_ptr<const ServerSnapshot> snapshot);
+
+private:
+    void adminLoop();
+    void serveOperator(int operatorSocket);
+    std::string execute(const std::string &line);
+    std::string submit(AdminCommandType type, const std::string &argument = "", int value = 0);
+    std::shared_ptr<const ServerSnapshot> latest() const;
+
+    ListenEndpoint endpoint;
+    int listenSocket = -1;
+    int wakePair[2] = {-1, -1};     // Admin thread writes to [1], game loop watches [0]
+
+    std::atomic<AdminCommand *> pending{nullptr};   // Newest first
+    std::atomic<bool> stopping{false};
+    std::thread admin;
+
+    mutable std::mutex snapshotMutex;
+    std::shared_ptr<const ServerSnapshot> snapshot = std::make_shared<ServerSnapshot>();
+};
+
+#endif // ADMIN_CONTROL_H
@@ -0,0 +1,258 @@
+#include "game_export.h"
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+const char EXPORT_MAGIC[] = "BCGAMES1";
+const uint8_t COLUMN_INTEGERS = 1;
+const uint8_t COLUMN_STRINGS = 2;
+const uint8_t CODEC_RAW = 0;
+const uint8_t CODEC_ZLIB = 1;
+const auto EXPORT_IDLE_WAIT = std::chrono::milliseconds(20);
+
+static const char *OUTCOME_NAMES[] = {"abandoned", "win", "draw", "forfeit"};
+
+/* ------------------------------------------------------------ ENCODING -------------------------------------------------------------------------*/
+
+static void putVarint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+static void putString(std::string &out, const std::string &value)
+{
+    putVarint(out, value.size());
+    out.append(value);
+}
+
+// One column of a row group, encoded as values are appended
+class ColumnWriter {
+public:
+    ColumnWriter(const char *name, uint8_t type) : name(name), type(type) {}
+
+    void add(int64_t value)
+    {
+        // Delta against the previous row, zigzag so small negative steps stay short
+        int64_t delta = value - previous;
+        previous = value;
+        putVarint(data, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    }
+
+    void add(const std::string &value)
+    {
+        putString(data, value);
+    }
+
+    void writeTo(std::string &out) const
+    {
+        std::string stored = data;
+        uint8_t codec = CODEC_RAW;
+#ifdef HAVE_ZLIB
+        uLongf size = compressBound(data.size());
+        std::string compressed(size, '\0');
+        if (compress2((Bytef *)&compressed[0], &size, (const Bytef *)data.data(), data.size(), Z_BEST_SPEED) == Z_OK && size < data.size())
+        {
+            compressed.resize(size);
+            stored.swap(compressed);
+            codec = CODEC_ZLIB;
+        }
+#endif
+        putString(out, name);
+        out.push_back((char)type);
+        out.push_back((char)codec);
+        putVarint(out, data.size());
+        putVarint(out, stored.size());
+        out.append(stored);
+    }
+
+private:
+    std::string name;
+    uint8_t type;
+    int64_t previous = 0;
+    std::string data;
+};
+
+static void writeRowGroup(std::string &out, const char *table, size_t rows, const std::vector<ColumnWriter> &columns)
+{
+    out.append("RG");
+    putString(out, table);
+    putVarint(out, rows);
+    putVarint(out, columns.size());
+    for (const ColumnWriter &column : columns)
+    {
+        column.writeTo(out);
+    }
+}
+
+/* ------------------------------------------------------------ EXPORTER -------------------------------------------------------------------------*/
+
+GameExporter::~GameExporter()
+{
+    if (writer.joinable())
+    {
+        stopping.store(true);
+        writer.join();
+    }
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+}
+
+bool GameExporter::start(const std::string &exportDirectory)
+{
+    directory = exportDirectory;
+    mkdir(directory.c_str(), 0755);
+
+    struct stat dirStat;
+    if (stat(directory.c_str(), &dirStat) != 0 || !S_ISDIR(dirStat.st_mode))
+    {
+        return false;
+    }
+
+    writer = std::thread(&GameExporter::writerLoop, this);
+    return true;
+}
+
+void GameExporter::submit(GameLog *game)
+{
+    uint64_t position = tail.load(std::memory_order_relaxed);
+    if (position - head.load(std::memory_order_acquire) >= EXPORT_QUEUE_CAPACITY)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        delete game;
+        return;
+    }
+    ring[position & (EXPORT_QUEUE_CAPACITY - 1)] = game;
+    tail.store(position + 1, std::memory_order_release);
+}
+
+uint64_t GameExporter::droppedGames() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void GameExporter::writerLoop()
+{
+    std::vector<std::unique_ptr<GameLog>> batch;
+    auto lastWrite = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        bool stop = stopping.load();
+
+        // Drain whatever the game loop has queued so far
+        uint64_t position = head.load(std::memory_order_relaxed);
+        uint64_t end = tail.load(std::memory_order_acquire);
+        for (; position != end && batch.size() < EXPORT_BATCH_SIZE; ++position)
+        {
+            batch.emplace_back(ring[position & (EXPORT_QUEUE_CAPACITY - 1)]);
+        }
+        head.store(position, std::memory_order_release);
+
+        auto now = std::chrono::steady_clock::now();
+        if (!batch.empty() && (batch.size() >= EXPORT_BATCH_SIZE || now - lastWrite >= std::chrono::seconds(1) || stop))
+        {
+            writeBatch(batch);
+            lastWrite = now;
+        }
+
+        if (stop && position == tail.load(std::memory_order_acquire) && batch.empty())
+        {
+            return;
+        }
+        if (position == end)
+        {
+            std::this_thread::sleep_for(EXPORT_IDLE_WAIT);
+        }
+    }
+}
+
+void GameExporter::writeBatch(std::vector<std::unique_ptr<GameLog>> &batch)
+{
+    rotateIfNeeded(time(nullptr));
+    if (file == nullptr)
+    {
+        batch.clear();
+        return;
+    }
+
+    std::vector<ColumnWriter> games = {
+        {"game_id", COLUMN_INTEGERS}, {"started_at", COLUMN_INTEGERS}, {"duration_ms", COLUMN_INTEGERS},
+        {"variant", COLUMN_STRINGS}, {"player1", COLUMN_STRINGS}, {"player2", COLUMN_STRINGS},
+        {"secret", COLUMN_STRINGS}, {"outcome", COLUMN_STRINGS}, {"winner", COLUMN_INTEGERS}, {"moves", COLUMN_INTEGERS}};
+    std::vector<ColumnWriter> moves = {
+        {"game_id", COLUMN_INTEGERS}, {"move", COLUMN_INTEGERS}, {"player", COLUMN_INTEGERS},
+        {"guess", COLUMN_STRINGS}, {"bulls", COLUMN_INTEGERS}, {"cows", COLUMN_INTEGERS}, {"offset_ms", COLUMN_INTEGERS}};
+    size_t moveRows = 0;
+
+    for (const auto &game : batch)
+    {
+        games[0].add(game->gameId);
+        games[1].add(game->startedAt);
+        games[2].add(game->endMs - game->startMs);
+        games[3].add(game->variant);
+        games[4].add(game->player1);
+        games[5].add(game->player2);
+        games[6].add(game->secret);
+        games[7].add(std::string(OUTCOME_NAMES[game->outcome]));
+        games[8].add(game->winner);
+        games[9].add((int64_t)game->moves.size());
+
+        for (size_t i = 0; i < game->moves.size(); ++i)
+        {
+            const GameMoveLog &move = game->moves[i];
+            moves[0].add(game->gameId);
+            moves[1].add((int64_t)i);
+            moves[2].add(move.player);
+            moves[3].add(move.guess);
+            moves[4].add(move.bulls);
+            moves[5].add(move.cows);
+            moves[6].add(move.offsetMs);
+        }
+        moveRows += game->moves.size();
+    }
+
+    std::string out;
+    writeRowGroup(out, "games", batch.size(), games);
+    writeRowGroup(out, "moves", moveRows, moves);
+    if (fwrite(out.data(), 1, out.size(), file) != out.size())
+    {
+        std::cerr << "[Export] Write failed, " << batch.size() << " games lost\n";
+    }
+    fflush(file);
+    fileBytes += out.size();
+    batch.clear();
+}
+
+void GameExporter::rotateIfNeeded(int64_t now)
+{
+    if (file != nullptr && fileBytes < EXPORT_MAX_FILE_BYTES && now - fileOpenedAt < EXPORT_MAX_FILE_SECONDS)
+    {
+        return;
+    }
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+
+    std::string path = directory + "/games-" + std::to_string(now) + "-" + std::to_string(fileSequence++) + ".bcg";
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::cerr << "[Export] Cannot create " << path << "\n";
+        return;
+    }
+    fwrite(EXPORT_MAGIC, 1, sizeof(EXPORT_MAGIC) - 1, file);
+    fileBytes = sizeof(EXPORT_MAGIC) - 1;
+    fileOpenedAt = now;
+}
@@ -0,0 +1,87 @@
+#ifndef GAME_EXPORT_H
+#define GAME_EXPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+const size_t EXPORT_QUEUE_CAPACITY = 65536;         // Finished games waiting for the writer, a power of two
+const size_t EXPORT_BATCH_SIZE = 8192;              // Games per row group
+const uint64_t EXPORT_MAX_FILE_BYTES = 64 << 20;    // Rotate to a new file beyond this size
+const int64_t EXPORT_MAX_FILE_SECONDS = 600;        // Rotate to a new file after this long
+
+enum GameOutcome : uint8_t {
+    OUTCOME_ABANDONED = 0,  // Both players left before the game ended
+    OUTCOME_WIN = 1,
+    OUTCOME_DRAW = 2,
+    OUTCOME_FORFEIT = 3     // The absent player did not come back within the grace period
+};
+
+struct GameMoveLog {
+    std::string guess;
+    uint8_t player;         // Seat that guessed, 1 or 2
+    uint8_t bulls;
+    uint8_t cows;
+    int64_t offsetMs;       // Milliseconds since the game started
+};
+
+// Everything recorded about one game, built by the game loop and owned by the exporter once the game is over
+struct GameLog {
+    int64_t gameId = 0;
+    std::string variant;
+    std::string secret;
+    std::string player1;
+    std::string player2;
+    int64_t startedAt = 0;  // Unix seconds, 0 until the second player joins
+    int64_t startMs = 0;    // Monotonic milliseconds at start
+    int64_t endMs = 0;
+    GameOutcome outcome = OUTCOME_ABANDONED;
+    uint8_t winner = 0;     // Winning seat, 0 for none
+    std::vector<GameMoveLog> moves;
+};
+
+// Writes finished games to rotating columnar files on a background thread.
+// The game loop hands over a pointer through a bounded single-producer queue and never waits.
+//
+// File layout: the magic "BCGAMES1", then row groups. A row group is
+//   "RG", table name, row count, column count, and per column:
+//   name, type (1 = zigzag delta varint integers, 2 = length-prefixed strings),
+//   codec (0 = raw, 1 = zlib), raw size, stored size, stored bytes.
+// Strings are a varint length and bytes; every size and count is a varint.
+class GameExporter {
+public:
+    ~GameExporter();
+
+    // Starts the writer, files go to the directory. False if it cannot be written to.
+    bool start(const std::string &directory);
+
+    // Takes ownership of the game; dropped and counted if the writer has fallen behind
+    void submit(GameLog *game);
+
+    uint64_t droppedGames() const;
+
+private:
+    void writerLoop();
+    void writeBatch(std::vector<std::unique_ptr<GameLog>> &batch);
+    void rotateIfNeeded(int64_t now);
+
+    std::string directory;
+    FILE *file = nullptr;
+    uint64_t fileBytes = 0;
+    int64_t fileOpenedAt = 0;
+    uint64_t fileSequence = 0;
+
+    // Single-producer single-consumer ring of owned pointers
+    std::vector<GameLog *> ring = std::vector<GameLog *>(EXPORT_QUEUE_CAPACITY);
+    std::atomic<uint64_t> head{0};  // Next slot the writer reads
+    std::atomic<uint64_t> tail{0};  // Next slot the game loop fills
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+};
+
+#endif // GAME_EXPORT_H
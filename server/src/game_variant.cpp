@@ -0,0 +1,100 @@
+#include "game_variant.h"
+#include <tuple>
+
+bool GameVariant::operator<(const GameVariant &other) const
+{
+    return std::tie(length, repeats, hex, maxTurns) < std::tie(other.length, other.repeats, other.hex, other.maxTurns);
+}
+
+bool GameVariant::operator==(const GameVariant &other) const
+{
+    return std::tie(length, repeats, hex, maxTurns) == std::tie(other.length, other.repeats, other.hex, other.maxTurns);
+}
+
+bool parseGameVariant(const std::string &spec, GameVariant &variant)
+{
+    GameVariant parsed;
+    size_t pos = 0;
+
+    // Reads a decimal number at pos, false if there is none
+    auto readNumber = [&](int &value) {
+        size_t start = pos;
+        value = 0;
+        while (pos < spec.size() && isdigit((unsigned char)spec[pos]) && pos - start < 4)
+        {
+            value = value * 10 + (spec[pos++] - '0');
+        }
+        return pos > start;
+    };
+
+    if (spec.empty() || spec[pos++] != 'V' || !readNumber(parsed.length))
+    {
+        return false;
+    }
+    if (pos < spec.size() && spec[pos] == 'R')
+    {
+        parsed.repeats = true;
+        pos++;
+    }
+    if (pos < spec.size() && spec[pos] == 'H')
+    {
+        parsed.hex = true;
+        pos++;
+    }
+    if (pos < spec.size() && spec[pos] == 'T')
+    {
+        pos++;
+        if (!readNumber(parsed.maxTurns) || parsed.maxTurns < 1)
+        {
+            return false;
+        }
+    }
+
+    if (pos != spec.size() || parsed.length < MIN_CODE_LENGTH || parsed.length > MAX_CODE_LENGTH || parsed.maxTurns > MAX_TURN_LIMIT)
+    {
+        return false;
+    }
+    variant = parsed;
+    return true;
+}
+
+std::string describeGameVariant(const GameVariant &variant)
+{
+    std::string description = "V" + std::to_string(variant.length);
+    if (variant.repeats)
+    {
+        description += "R";
+    }
+    if (variant.hex)
+    {
+        description += "H";
+    }
+    if (variant.maxTurns > 0)
+    {
+        description += "T" + std::to_string(variant.maxTurns);
+    }
+    return description;
+}
+
+/* ------------------------------------------------------------ KERNEL TABLE ---------------------------------------------------------------------*/
+
+// Every (length, repeats, hex) combination is instantiated here, four per length
+template <size_t Index>
+constexpr VariantKernel makeKernel()
+{
+    using Rules = VariantRules<MIN_CODE_LENGTH + Index / 4, (Index / 2) % 2 == 1, Index % 2 == 1>;
+    return VariantKernel{&Rules::validate, Rules::CODE_COUNT, &Rules::decode, &Rules::score};
+}
+
+template <size_t... Index>
+constexpr std::array<VariantKernel, sizeof...(Index)> makeKernelTable(std::index_sequence<Index...>)
+{
+    return {makeKernel<Index>()...};
+}
+
+static constexpr auto KERNELS = makeKernelTable(std::make_index_sequence<(MAX_CODE_LENGTH - MIN_CODE_LENGTH + 1) * 4>());
+
+const VariantKernel &kernelFor(const GameVariant &variant)
+{
+    return KERNELS[(variant.length - MIN_CODE_LENGTH) * 4 + variant.repeats * 2 + variant.hex];
+}
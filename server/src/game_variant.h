@@ -0,0 +1,189 @@
+#ifndef GAME_VARIANT_H
+#define GAME_VARIANT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+const int MIN_CODE_LENGTH = 3;
+const int MAX_CODE_LENGTH = 10;
+const int MAX_TURN_LIMIT = 1000;
+const char VARIANT_SEPARATOR = '#';   // "nickname#V5RHT20" asks for a variant at matchmaking
+
+enum GuessValidationCode
+{
+    VALID_GUESS = 0,
+    ERROR_NO_G_PREFIX = -1,
+    ERROR_LENGTH = -2,
+    ERROR_NOT_DIGITS = -3,
+    ERROR_NOT_UNIQUE = -4
+};
+
+// Rules a session is played with, chosen when the player is matched
+struct GameVariant {
+    int length = 4;         // Code length, MIN_CODE_LENGTH..MAX_CODE_LENGTH
+    bool repeats = false;   // Whether a symbol may appear more than once
+    bool hex = false;       // Symbols 0-9a-f instead of 0-9
+    int maxTurns = 0;       // Guesses per game before it ends in a draw, 0 for no limit
+
+    bool operator<(const GameVariant &other) const;
+    bool operator==(const GameVariant &other) const;
+};
+
+// Entry points of the kernel compiled for one combination of length, repeats and alphabet
+struct VariantKernel {
+    int (*validate)(const char *code, size_t size);
+    uint64_t codeCount;                             // Distinct codes of the variant
+    void (*decode)(uint64_t index, char *out);      // Code number index, below codeCount
+    std::pair<int, int> (*score)(const char *guess, const char *secret);
+};
+
+// Parses "V<length>[R][H][T<turns>]", false if the spec is malformed or out of range
+bool parseGameVariant(const std::string &spec, GameVariant &variant);
+std::string describeGameVariant(const GameVariant &variant);
+
+// Kernel for the variant, resolved once when the session is created
+const VariantKernel &kernelFor(const GameVariant &variant);
+
+/* ------------------------------------------------------------ KERNELS --------------------------------------------------------------------------*/
+
+// Symbol value of every byte, 0xFF for bytes outside the alphabet
+template <bool Hex>
+constexpr std::array<uint8_t, 256> makeSymbolTable()
+{
+    std::array<uint8_t, 256> table{};
+    for (auto &entry : table)
+    {
+        entry = 0xFF;
+    }
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        table['0' + digit] = digit;
+    }
+    if (Hex)
+    {
+        // Lowercase only, 'B' and 'C' separate bulls and cows in the answer
+        for (int digit = 0; digit < 6; ++digit)
+        {
+            table['a' + digit] = 10 + digit;
+        }
+    }
+    return table;
+}
+
+template <int Length, bool Repeats, bool Hex>
+struct VariantRules {
+    static constexpr int ALPHABET_SIZE = Hex ? 16 : 10;
+    static constexpr std::array<uint8_t, 256> SYMBOLS = makeSymbolTable<Hex>();
+    static constexpr char ALPHABET[] = "0123456789abcdef";
+
+    static_assert(Length >= MIN_CODE_LENGTH && Length <= MAX_CODE_LENGTH, "Unsupported code length");
+    static_assert(Repeats || Length <= ALPHABET_SIZE, "Not enough symbols for a code without repeats");
+
+    static int validate(const char *code, size_t size)
+    {
+        if (size != Length)
+        {
+            return ERROR_LENGTH;
+        }
+
+        // One pass over a fixed-length code, no early exits
+        uint8_t invalid = 0;
+        uint32_t seen = 0;
+        for (int i = 0; i < Length; ++i)
+        {
+            uint8_t symbol = SYMBOLS[(unsigned char)code[i]];
+            invalid |= symbol >> 7;
+            seen |= 1u << (symbol & 15);
+        }
+
+        if (invalid)
+        {
+            return ERROR_NOT_DIGITS;
+        }
+        if (!Repeats && __builtin_popcount(seen) != Length)
+        {
+            return ERROR_NOT_UNIQUE;
+        }
+        return VALID_GUESS;
+    }
+
+    // Codes of the variant: ALPHABET_SIZE^Length with repeats, ALPHABET_SIZE!/(ALPHABET_SIZE-Length)! without
+    static constexpr uint64_t CODE_COUNT = [] {
+        uint64_t count = 1;
+        for (int i = 0; i < Length; ++i)
+        {
+            count *= Repeats ? ALPHABET_SIZE : ALPHABET_SIZE - i;
+        }
+        return count;
+    }();
+
+    // Every index below CODE_COUNT gives a different code, so one uniform draw is a uniform secret
+    static void decode(uint64_t index, char *out)
+    {
+        if constexpr (Repeats)
+        {
+            for (int i = 0; i < Length; ++i)
+            {
+                out[i] = ALPHABET[index % ALPHABET_SIZE];
+                index /= ALPHABET_SIZE;
+            }
+            return;
+        }
+
+        // Mixed radix: the digit of position i picks one of the ALPHABET_SIZE - i symbols still unused
+        char symbols[ALPHABET_SIZE];
+        for (int i = 0; i < ALPHABET_SIZE; ++i)
+        {
+            symbols[i] = ALPHABET[i];
+        }
+        for (int i = 0; i < Length; ++i)
+        {
+            int pick = i + index % (ALPHABET_SIZE - i);
+            index /= ALPHABET_SIZE - i;
+            std::swap(symbols[i], symbols[pick]);
+            out[i] = symbols[i];
+        }
+    }
+
+    static std::pair<int, int> score(const char *guess, const char *secret)
+    {
+        int bulls = 0;
+        for (int i = 0; i < Length; ++i)
+        {
+            bulls += guess[i] == secret[i];
+        }
+
+        if constexpr (!Repeats)
+        {
+            // Unique symbols: every shared symbol is either a bull or a cow
+            uint32_t guessMask = 0, secretMask = 0;
+            for (int i = 0; i < Length; ++i)
+            {
+                guessMask |= 1u << SYMBOLS[(unsigned char)guess[i]];
+                secretMask |= 1u << SYMBOLS[(unsigned char)secret[i]];
+            }
+            return {bulls, __builtin_popcount(guessMask & secretMask) - bulls};
+        }
+
+        // Repeated symbols: matches are the overlap of both symbol histograms
+        uint8_t guessCounts[ALPHABET_SIZE] = {};
+        uint8_t secretCounts[ALPHABET_SIZE] = {};
+        for (int i = 0; i < Length; ++i)
+        {
+            guessCounts[SYMBOLS[(unsigned char)guess[i]]]++;
+            secretCounts[SYMBOLS[(unsigned char)secret[i]]]++;
+        }
+        int matches = 0;
+        for (int symbol = 0; symbol < ALPHABET_SIZE; ++symbol)
+        {
+            matches += std::min(guessCounts[symbol], secretCounts[symbol]);
+        }
+        return {bulls, matches - bulls};
+    }
+};
+
+#endif // GAME_VARIANT_H
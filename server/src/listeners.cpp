@@ -0,0 +1,131 @@
+#include "listeners.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool parseListenEndpoint(const std::string &spec, int defaultPort, ListenEndpoint &endpoint)
+{
+    if (spec.compare(0, strlen(UNIX_ENDPOINT_PREFIX), UNIX_ENDPOINT_PREFIX) == 0)
+    {
+        endpoint.kind = ListenEndpoint::UNIX;
+        endpoint.address = spec.substr(strlen(UNIX_ENDPOINT_PREFIX));
+        return !endpoint.address.empty() && endpoint.address.size() < sizeof(sockaddr_un::sun_path);
+    }
+
+    endpoint.kind = ListenEndpoint::TCP6;
+    endpoint.port = defaultPort;
+    endpoint.address = spec;
+    if (!spec.empty() && spec[0] == '[')
+    {
+        size_t close = spec.find(']');
+        if (close == std::string::npos)
+        {
+            return false;
+        }
+        endpoint.address = spec.substr(1, close - 1);
+        if (close + 1 < spec.size())
+        {
+            if (spec[close + 1] != ':')
+            {
+                return false;
+            }
+            try
+            {
+                endpoint.port = std::stoi(spec.substr(close + 2));
+            }
+            catch (const std::exception &)
+            {
+                return false;
+            }
+        }
+    }
+
+    struct in6_addr parsed;
+    return endpoint.port >= 0 && endpoint.port <= 65535 && inet_pton(AF_INET6, endpoint.address.c_str(), &parsed) == 1;
+}
+
+std::string describeListenEndpoint(const ListenEndpoint &endpoint)
+{
+    if (endpoint.kind == ListenEndpoint::UNIX)
+    {
+        return UNIX_ENDPOINT_PREFIX + endpoint.address;
+    }
+    return "[" + endpoint.address + "]:" + std::to_string(endpoint.port);
+}
+
+// A socket file nobody accepts on refuses connections; anything else may still be in use
+static bool isStaleUnixSocket(const struct sockaddr_un &unix_addr)
+{
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0)
+    {
+        return false;
+    }
+    fcntl(probe, F_SETFL, O_NONBLOCK);
+    bool stale = connect(probe, (const struct sockaddr *)&unix_addr, sizeof(unix_addr)) != 0 && errno == ECONNREFUSED;
+    close(probe);
+    return stale;
+}
+
+int openListenSocket(const ListenEndpoint &endpoint, int backlog)
+{
+    int listenSocket = socket(endpoint.kind == ListenEndpoint::UNIX ? AF_UNIX : AF_INET6, SOCK_STREAM, 0);
+    if (listenSocket < 0)
+    {
+        std::cerr << "[Server] Socket creation failed for " << describeListenEndpoint(endpoint) << "\n";
+        return -1;
+    }
+    fcntl(listenSocket, F_SETFL, O_NONBLOCK);
+
+    int bound;
+    if (endpoint.kind == ListenEndpoint::UNIX)
+    {
+        struct sockaddr_un unix_addr = {};
+        unix_addr.sun_family = AF_UNIX;
+        strncpy(unix_addr.sun_path, endpoint.address.c_str(), sizeof(unix_addr.sun_path) - 1);
+        // Only a stale socket from an earlier run is removed, never a file the path was mistyped onto
+        // nor the socket of a server still listening on it
+        struct stat existing;
+        if (lstat(endpoint.address.c_str(), &existing) == 0)
+        {
+            const char *problem = !S_ISSOCK(existing.st_mode) ? "the path exists and is not a socket"
+                                  : !isStaleUnixSocket(unix_addr) ? "another process is listening on it"
+                                  : nullptr;
+            if (problem != nullptr)
+            {
+                std::cerr << "[Server] Cannot listen on " << describeListenEndpoint(endpoint) << ": " << problem << "\n";
+                close(listenSocket);
+                return -1;
+            }
+            unlink(endpoint.address.c_str());
+        }
+        bound = bind(listenSocket, (struct sockaddr *)&unix_addr, sizeof(unix_addr));
+    }
+    else
+    {
+        // IPv6 only, the IPv4 socket may already hold the same port
+        int v6only = 1;
+        setsockopt(listenSocket, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+
+        struct sockaddr_in6 server_addr = {};
+        server_addr.sin6_family = AF_INET6;
+        server_addr.sin6_port = htons(endpoint.port);
+        inet_pton(AF_INET6, endpoint.address.c_str(), &server_addr.sin6_addr);
+        bound = bind(listenSocket, (struct sockaddr *)&server_addr, sizeof(server_addr));
+    }
+
+    if (bound < 0 || listen(listenSocket, backlog) < 0)
+    {
+        std::cerr << "[Server] Cannot listen on " << describeListenEndpoint(endpoint) << ": " << strerror(errno) << "\n";
+        close(listenSocket);
+        return -1;
+    }
+    return listenSocket;
+}
@@ -0,0 +1,23 @@
+#ifndef LISTENERS_H
+#define LISTENERS_H
+
+#include <string>
+
+const char UNIX_ENDPOINT_PREFIX[] = "unix:";   // "unix:/run/bc.sock" listens on a local socket file
+
+// Endpoint the server accepts connections on in addition to its IPv4 socket
+struct ListenEndpoint {
+    enum Kind { UNIX, TCP6 } kind = TCP6;
+    std::string address;    // Socket path, or IPv6 address to bind
+    int port = 0;           // TCP6 only
+};
+
+// Parses "unix:<path>", "[<ipv6>]:<port>" or "<ipv6>" (uses defaultPort), false if malformed
+bool parseListenEndpoint(const std::string &spec, int defaultPort, ListenEndpoint &endpoint);
+std::string describeListenEndpoint(const ListenEndpoint &endpoint);
+
+// Creates, binds and listens on a non-blocking socket for the endpoint, -1 on failure.
+// A stale socket file left by a previous run is replaced.
+int openListenSocket(const ListenEndpoint &endpoint, int backlog);
+
+#endif // LISTENERS_H
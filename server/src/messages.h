@@ -32,6 +32,9 @@ const std::string WIN_MSG = "WIN\n";
 // std::string loseMessage = "You lost. The secret number was guessed by your opponent.\n"
 const std::string LOST_MSG = "LOST\n";
 
+//"Nobody guessed the number within the turn limit\n"
+const std::string DRAW_MSG = "DRAW\n";
+
 // std::string endGameMessage = "The game has ended. Thank you for playing!\n"
 //                              "If you want to continue, enter new nickname\n";
 const std::string ENDGAME_MSG = "EG\n";
@@ -48,4 +51,13 @@ const std::string GAME_START = "SG\n";
 //"Message must start with 'G'. Disconnecting.\n"
 const std::string WRONG_FORMAT = "WF\n";
 
+//"Unknown game variant. Use nickname#V<length>[R][H][T<turns>]\n"
+const std::string INVALID_VARIANT = "IV\n";
+
+//"Which heartbeat interval do you accept?", sent by clients that can stretch their PINGs
+const std::string HEARTBEAT_REQUEST = "HB\n";
+
+// Answer to HEARTBEAT_REQUEST: "HB<seconds>\n", the interval the client may PING at
+const std::string HEARTBEAT_PREFIX = "HB";
+
 #endif
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include "player_stats.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint64_t STATS_MAGIC = 0x3153544154534342ULL;    // "BCSTATS1"
+const uint32_t STATS_VERSION = 1;
+const size_t STATS_NICKNAME_SIZE = 24;                  // Longer than MAX_NICKNAME_LENGTH plus terminator
+const double STATS_MAX_LOAD = 0.9;                      // New players are not recorded beyond this load
+const double RATING_K_FACTOR = 32.0;
+const auto STATS_BATCH_INTERVAL = std::chrono::milliseconds(200);
+
+struct PlayerStatsStore::FileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+    uint64_t count;
+    uint8_t reserved[32];
+};
+
+// One slot of the hash table; sequence is odd while the writer is changing the record
+struct PlayerStatsStore::Record {
+    std::atomic<uint32_t> sequence;
+    uint32_t used;
+    char nickname[STATS_NICKNAME_SIZE];
+    uint32_t games;
+    uint32_t wins;
+    uint32_t losses;
+    uint32_t draws;
+    uint32_t guessesInWins;     // Sum over wins that were not forfeits
+    uint32_t guessedWins;       // Wins that were not forfeits
+    double rating;
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == 4 && std::atomic<uint32_t>::is_always_lock_free, "Records need address-free atomics");
+
+static uint64_t hashNickname(const std::string &nickname)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : nickname)
+    {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+PlayerStatsStore::~PlayerStatsStore()
+{
+    if (writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_one();
+        writer.join();
+    }
+    if (header != nullptr)
+    {
+        msync(header, mappedSize, MS_SYNC);
+        munmap(header, mappedSize);
+    }
+    if (fd != -1)
+    {
+        close(fd);
+    }
+}
+
+bool PlayerStatsStore::open(const std::string &path)
+{
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        return false;
+    }
+
+    // A new file is sized once; unused slots stay sparse on disk
+    FileHeader existing{};
+    bool fresh = fileStat.st_size < (off_t)sizeof(FileHeader);
+    if (!fresh && (pread(fd, &existing, sizeof(existing), 0) != sizeof(existing) || existing.magic != STATS_MAGIC ||
+                   existing.version != STATS_VERSION || existing.recordSize != sizeof(Record) ||
+                   existing.capacity == 0 || (existing.capacity & (existing.capacity - 1)) != 0))
+    {
+        std::cerr << "[Stats] " << path << " is not a player statistics file\n";
+        return false;
+    }
+
+    capacity = fresh ? PLAYER_STATS_CAPACITY : existing.capacity;
+    mappedSize = sizeof(FileHeader) + capacity * sizeof(Record);
+    if (fresh && ftruncate(fd, mappedSize) != 0)
+    {
+        return false;
+    }
+
+    // Slots past the end of a truncated file would fault on first touch
+    if (!fresh && (uint64_t)fileStat.st_size < mappedSize)
+    {
+        std::cerr << "[Stats] " << path << " is shorter than its " << capacity << " slots need\n";
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+    header = static_cast<FileHeader *>(mapping);
+    records = reinterpret_cast<Record *>(static_cast<char *>(mapping) + sizeof(FileHeader));
+
+    if (fresh)
+    {
+        header->magic = STATS_MAGIC;
+        header->version = STATS_VERSION;
+        header->recordSize = sizeof(Record);
+        header->capacity = capacity;
+        header->count = 0;
+    }
+
+    // The rating index lives in memory and is rebuilt once at startup.
+    // No reader exists yet, so records left mid-update by a crashed writer get an even sequence again;
+    // an odd one would keep every reader of the slot retrying forever.
+    uint64_t interrupted = 0;
+    for (uint64_t slot = 0; slot < capacity; ++slot)
+    {
+        uint32_t sequence = records[slot].sequence.load(std::memory_order_relaxed);
+        if (sequence & 1)
+        {
+            records[slot].sequence.store(sequence + 1, std::memory_order_relaxed);
+            interrupted++;
+        }
+        if (records[slot].used)
+        {
+            ratingIndex.emplace(records[slot].rating, slot);
+        }
+    }
+    if (interrupted > 0)
+    {
+        std::cerr << "[Stats] " << interrupted << " records in " << path << " were being written when the server stopped\n";
+    }
+    publishLeaderboard();
+
+    writer = std::thread(&PlayerStatsStore::writerLoop, this);
+    return true;
+}
+
+void PlayerStatsStore::record(const GameResult &result)
+{
+    // The game loop only appends to the batch
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push_back(result);
+    }
+}
+
+bool PlayerStatsStore::lookup(const std::string &nickname, PlayerStats &stats) const
+{
+    const Record *record = find(nickname);
+    if (record == nullptr)
+    {
+        return false;
+    }
+    readRecord(*record, stats);
+    return true;
+}
+
+std::vector<PlayerStats> PlayerStatsStore::topPlayers(size_t count) const
+{
+    std::shared_ptr<const std::vector<PlayerStats>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(leaderboardMutex);
+        snapshot = leaderboard;
+    }
+    return std::vector<PlayerStats>(snapshot->begin(), snapshot->begin() + std::min(count, snapshot->size()));
+}
+
+size_t PlayerStatsStore::playerCount() const
+{
+    return header != nullptr ? __atomic_load_n(&header->count, __ATOMIC_RELAXED) : 0;
+}
+
+/* ------------------------------------------------------------ WRITER THREAD --------------------------------------------------------------------*/
+
+void PlayerStatsStore::writerLoop()
+{
+    std::vector<GameResult> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait_for(lock, STATS_BATCH_INTERVAL, [this] { return stopping; });
+            batch.swap(pending);
+            if (batch.empty() && stopping)
+            {
+                return;
+            }
+        }
+
+        if (batch.empty())
+        {
+            continue;
+        }
+        for (const GameResult &result : batch)
+        {
+            apply(result);
+        }
+        batch.clear();
+
+        publishLeaderboard();
+        msync(header, mappedSize, MS_ASYNC);
+    }
+}
+
+void PlayerStatsStore::apply(const GameResult &result)
+{
+    Record *first = findOrInsert(result.winner);
+    Record *second = findOrInsert(result.loser);
+    if (first == nullptr || second == nullptr || first == second)
+    {
+        return;
+    }
+
+    // Elo update, a draw scores half a point each
+    double score = result.draw ? 0.5 : 1.0;
+    double expected = 1.0 / (1.0 + std::pow(10.0, (second->rating - first->rating) / 400.0));
+    double change = RATING_K_FACTOR * (score - expected);
+
+    for (Record *record : {first, second})
+    {
+        uint64_t slot = record - records;
+        ratingIndex.erase({record->rating, slot});
+
+        uint32_t sequence = record->sequence.load(std::memory_order_relaxed);
+        record->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        record->games++;
+        if (result.draw)
+        {
+            record->draws++;
+        }
+        else if (record == first)
+        {
+            record->wins++;
+            if (result.winnerGuesses > 0)
+            {
+                record->guessesInWins += result.winnerGuesses;
+                record->guessedWins++;
+            }
+        }
+        else
+        {
+            record->losses++;
+        }
+        record->rating += record == first ? change : -change;
+
+        record->sequence.store(sequence + 2, std::memory_order_release);
+        ratingIndex.emplace(record->rating, slot);
+    }
+}
+
+PlayerStatsStore::Record *PlayerStatsStore::findOrInsert(const std::string &nickname)
+{
+    uint64_t mask = capacity - 1;
+    for (uint64_t probe = 0, slot = hashNickname(nickname) & mask; probe < capacity; ++probe, slot = (slot + 1) & mask)
+    {
+        Record &record = records[slot];
+        if (record.used)
+        {
+            if (strncmp(record.nickname, nickname.c_str(), STATS_NICKNAME_SIZE) == 0)
+            {
+                return &record;
+            }
+            continue;
+        }
+
+        if (header->count >= capacity * STATS_MAX_LOAD)
+        {
+            std::cerr << "[Stats] Statistics file is full, not recording " << nickname << "\n";
+            return nullptr;
+        }
+
+        // Claim the empty slot; readers probing past it see either nothing or the whole record
+        uint32_t sequence = record.sequence.load(std::memory_order_relaxed);
+        record.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        strncpy(record.nickname, nickname.c_str(), STATS_NICKNAME_SIZE - 1);
+        record.nickname[STATS_NICKNAME_SIZE - 1] = '\0';
+        record.games = record.wins = record.losses = record.draws = 0;
+        record.guessesInWins = record.guessedWins = 0;
+        record.rating = INITIAL_RATING;
+        record.used = 1;
+        record.sequence.store(sequence + 2, std::memory_order_release);
+
+        __atomic_store_n(&header->count, header->count + 1, __ATOMIC_RELAXED);
+        ratingIndex.emplace(record.rating, slot);
+        return &record;
+    }
+    return nullptr;
+}
+
+/* ------------------------------------------------------------ READERS --------------------------------------------------------------------------*/
+
+const PlayerStatsStore::Record *PlayerStatsStore::find(const std::string &nickname) const
+{
+    if (records == nullptr)
+    {
+        return nullptr;
+    }
+
+    uint64_t mask = capacity - 1;
+    for (uint64_t probe = 0, slot = hashNickname(nickname) & mask; probe < capacity; ++probe, slot = (slot + 1) & mask)
+    {
+        const Record &record = records[slot];
+
+        // Seqlock read of the probe key, retried if the writer is inside the record
+        uint32_t used;
+        char stored[STATS_NICKNAME_SIZE];
+        uint32_t before, after;
+        do
+        {
+            before = record.sequence.load(std::memory_order_acquire);
+            used = record.used;
+            memcpy(stored, record.nickname, sizeof(stored));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = record.sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        if (!used)
+        {
+            return nullptr;
+        }
+        if (strncmp(stored, nickname.c_str(), STATS_NICKNAME_SIZE) == 0)
+        {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+void PlayerStatsStore::readRecord(const Record &record, PlayerStats &stats) const
+{
+    uint32_t before, after;
+    do
+    {
+        before = record.sequence.load(std::memory_order_acquire);
+        stats.nickname.assign(record.nickname, strnlen(record.nickname, STATS_NICKNAME_SIZE));
+        stats.games = record.games;
+        stats.wins = record.wins;
+        stats.losses = record.losses;
+        stats.draws = record.draws;
+        stats.averageGuessesToWin = record.guessedWins > 0 ? (double)record.guessesInWins / record.guessedWins : 0;
+        stats.rating = record.rating;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = record.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+void PlayerStatsStore::publishLeaderboard()
+{
+    // Walk the rating index from the top, no scan over all players
+    auto top = std::make_shared<std::vector<PlayerStats>>();
+    for (auto it = ratingIndex.rbegin(); it != ratingIndex.rend() && top->size() < LEADERBOARD_SIZE; ++it)
+    {
+        PlayerStats stats;
+        readRecord(records[it->second], stats);
+        top->push_back(stats);
+    }
+
+    std::lock_guard<std::mutex> lock(leaderboardMutex);
+    leaderboard = top;
+}
@@ -0,0 +1,88 @@
+#ifndef PLAYER_STATS_H
+#define PLAYER_STATS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint64_t PLAYER_STATS_CAPACITY = 1 << 20;    // Record slots in a new file, a power of two
+const double INITIAL_RATING = 1500.0;
+const size_t LEADERBOARD_SIZE = 100;               // Players kept in the published leaderboard
+
+// Outcome of one finished game, handed to the store by the game loop
+struct GameResult {
+    std::string winner;         // Winner, or first player of a draw
+    std::string loser;          // Loser, or second player of a draw
+    bool draw = false;
+    int winnerGuesses = 0;      // Guesses the winner needed, 0 if the game was won by forfeit
+};
+
+// Copy of one player's record
+struct PlayerStats {
+    std::string nickname;
+    uint32_t games = 0;
+    uint32_t wins = 0;
+    uint32_t losses = 0;
+    uint32_t draws = 0;
+    double averageGuessesToWin = 0;
+    double rating = INITIAL_RATING;
+};
+
+// Player statistics in a memory-mapped file of fixed records, indexed by an open-addressing hash on the nickname.
+// The game loop reads records without locks and queues results; a writer thread applies them in batches.
+class PlayerStatsStore {
+public:
+    ~PlayerStatsStore();
+
+    // Maps the file, creating it if needed, and starts the writer thread. False if the file cannot be used.
+    bool open(const std::string &path);
+
+    // Queues a result for the writer thread
+    void record(const GameResult &result);
+
+    // Reads a player's record without blocking the writer, false for unknown players
+    bool lookup(const std::string &nickname, PlayerStats &stats) const;
+
+    // Best players by rating, served from the snapshot published after each batch
+    std::vector<PlayerStats> topPlayers(size_t count) const;
+
+    size_t playerCount() const;
+
+private:
+    struct FileHeader;
+    struct Record;
+
+    void writerLoop();
+    void apply(const GameResult &result);
+    Record *findOrInsert(const std::string &nickname);
+    const Record *find(const std::string &nickname) const;
+    void readRecord(const Record &record, PlayerStats &stats) const;
+    void publishLeaderboard();
+
+    int fd = -1;
+    size_t mappedSize = 0;
+    FileHeader *header = nullptr;
+    Record *records = nullptr;
+    uint64_t capacity = 0;
+
+    // Result queue between the game loop and the writer
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::vector<GameResult> pending;
+    bool stopping = false;
+    std::thread writer;
+
+    // Rating index, owned by the writer thread
+    std::set<std::pair<double, uint64_t>> ratingIndex;
+
+    mutable std::mutex leaderboardMutex;
+    std::shared_ptr<const std::vector<PlayerStats>> leaderboard = std::make_shared<std::vector<PlayerStats>>();
+};
+
+#endif // PLAYER_STATS_H
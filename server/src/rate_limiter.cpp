@@ -0,0 +1,181 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <cmath>
+
+const int64_t MIN_THROTTLE_MS = 250;      // Shortest pause in reading a flooding socket
+const int64_t STRIKE_WINDOW_MS = 60000;   // Strikes older than this are forgotten
+const int64_t ADDRESS_IDLE_MS = 60000;    // Address budgets outlive their last connection by this long
+
+/* ------------------------------------------------------------ TOKEN BUCKET ---------------------------------------------------------------------*/
+
+TokenBucket::TokenBucket(double ratePerSecond, double burst, int64_t nowMs)
+    : rate(ratePerSecond), capacity(burst), tokens(burst), lastRefillMs(nowMs)
+{
+}
+
+bool TokenBucket::consume(double amount, int64_t nowMs)
+{
+    refill(nowMs);
+    if (tokens < amount)
+    {
+        return false;
+    }
+    tokens -= amount;
+    return true;
+}
+
+bool TokenBucket::available(double amount, int64_t nowMs)
+{
+    refill(nowMs);
+    return tokens >= amount;
+}
+
+int64_t TokenBucket::millisUntilAvailable(double amount, int64_t nowMs)
+{
+    refill(nowMs);
+    if (tokens >= amount)
+    {
+        return 0;
+    }
+    if (rate <= 0)
+    {
+        return INT64_MAX;
+    }
+    return static_cast<int64_t>(std::ceil((std::min(amount, capacity) - tokens) * 1000.0 / rate));
+}
+
+void TokenBucket::refill(int64_t nowMs)
+{
+    if (nowMs > lastRefillMs)
+    {
+        tokens = std::min(capacity, tokens + (nowMs - lastRefillMs) * rate / 1000.0);
+        lastRefillMs = nowMs;
+    }
+}
+
+/* ------------------------------------------------------------ FLOOD GUARD ----------------------------------------------------------------------*/
+
+FloodGuard::FloodGuard(const RateLimitConfig &config, int64_t nowMs)
+    : frames(config.framesPerSecond, config.frameBurst, nowMs),
+      bytes(config.bytesPerSecond, config.byteBurst, nowMs)
+{
+}
+
+bool FloodGuard::admit(size_t size, int64_t nowMs)
+{
+    // Both budgets are charged so a flood of tiny frames and a few huge ones are both caught,
+    // but only together: a refused frame must not eat into either of them
+    if (!canAdmit(size, nowMs))
+    {
+        return false;
+    }
+    frames.consume(1, nowMs);
+    bytes.consume(static_cast<double>(size), nowMs);
+    return true;
+}
+
+bool FloodGuard::canAdmit(size_t size, int64_t nowMs)
+{
+    return frames.available(1, nowMs) && bytes.available(static_cast<double>(size), nowMs);
+}
+
+int64_t FloodGuard::millisUntilAdmit(size_t size, int64_t nowMs)
+{
+    return std::max(frames.millisUntilAvailable(1, nowMs), bytes.millisUntilAvailable(static_cast<double>(size), nowMs));
+}
+
+/* ------------------------------------------------------------ RATE LIMITER ---------------------------------------------------------------------*/
+
+RateLimiter::RateLimiter(const RateLimitConfig &perConnection, const RateLimitConfig &perAddress, int maxStrikes)
+    : perConnection(perConnection), perAddress(perAddress), maxStrikes(maxStrikes)
+{
+}
+
+RateLimiter::AddressState &RateLimiter::addressState(const std::string &address, int64_t nowMs)
+{
+    expireIdleAddresses(nowMs);
+    auto it = addresses.find(address);
+    if (it == addresses.end())
+    {
+        it = addresses.emplace(address, AddressState{FloodGuard(perAddress, nowMs), 0, 0}).first;
+    }
+    return it->second;
+}
+
+void RateLimiter::expireIdleAddresses(int64_t nowMs)
+{
+    while (!idleAddresses.empty() && idleAddresses.front().first + ADDRESS_IDLE_MS <= nowMs)
+    {
+        // Skip addresses that came back since, they are queued again on their next last close
+        auto it = addresses.find(idleAddresses.front().second);
+        if (it != addresses.end() && it->second.connections == 0 && it->second.idleSinceMs == idleAddresses.front().first)
+        {
+            addresses.erase(it);
+        }
+        idleAddresses.pop_front();
+    }
+}
+
+bool RateLimiter::admitConnection(const std::string &address, int64_t nowMs)
+{
+    // An accept costs a frame, so reconnecting in a loop drains the address like flooding does
+    return addressState(address, nowMs).guard.admit(0, nowMs);
+}
+
+ConnectionRateState RateLimiter::openConnection(const std::string &address, int64_t nowMs)
+{
+    addressState(address, nowMs).connections++;
+
+    ConnectionRateState state;
+    state.guard = FloodGuard(perConnection, nowMs);
+    return state;
+}
+
+void RateLimiter::closeConnection(const std::string &address, int64_t nowMs)
+{
+    auto it = addresses.find(address);
+    if (it != addresses.end() && --it->second.connections <= 0)
+    {
+        it->second.connections = 0;
+        it->second.idleSinceMs = nowMs;
+        idleAddresses.emplace_back(nowMs, address);
+    }
+}
+
+RateVerdict RateLimiter::admit(ConnectionRateState &state, const std::string &address, size_t bytes, int64_t nowMs)
+{
+    auto addressIt = addresses.find(address);
+    // Charged only when the connection and its address both have budget, a throttled frame costs nothing
+    bool allowed = state.guard.canAdmit(bytes, nowMs) &&
+                   (addressIt == addresses.end() || addressIt->second.guard.canAdmit(bytes, nowMs));
+    if (allowed)
+    {
+        state.guard.admit(bytes, nowMs);
+        if (addressIt != addresses.end())
+        {
+            addressIt->second.guard.admit(bytes, nowMs);
+        }
+        return RateVerdict::ALLOW;
+    }
+
+    if (nowMs - state.lastStrikeMs > STRIKE_WINDOW_MS)
+    {
+        state.strikes = 0;
+    }
+    state.strikes++;
+    state.lastStrikeMs = nowMs;
+
+    if (state.strikes >= maxStrikes)
+    {
+        return RateVerdict::DISCONNECT;
+    }
+
+    // Pause reading until both the connection and its address have budget for this frame again
+    int64_t waitMs = state.guard.millisUntilAdmit(bytes, nowMs);
+    if (addressIt != addresses.end())
+    {
+        waitMs = std::max(waitMs, addressIt->second.guard.millisUntilAdmit(bytes, nowMs));
+    }
+    state.resumeAtMs = nowMs + std::clamp(waitMs, MIN_THROTTLE_MS, STRIKE_WINDOW_MS);
+    return RateVerdict::THROTTLE;
+}
@@ -0,0 +1,105 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+// Classic token bucket: refills at a fixed rate up to its burst size
+class TokenBucket {
+public:
+    TokenBucket() = default;
+    TokenBucket(double ratePerSecond, double burst, int64_t nowMs);
+
+    bool consume(double amount, int64_t nowMs);
+
+    // Whether amount tokens could be consumed now, without consuming them
+    bool available(double amount, int64_t nowMs);
+
+    // Milliseconds until amount tokens are available again
+    int64_t millisUntilAvailable(double amount, int64_t nowMs);
+
+private:
+    void refill(int64_t nowMs);
+
+    double rate = 0;
+    double capacity = 0;
+    double tokens = 0;
+    int64_t lastRefillMs = 0;
+};
+
+struct RateLimitConfig {
+    double framesPerSecond;
+    double frameBurst;
+    double bytesPerSecond;
+    double byteBurst;
+};
+
+// Frame and byte budget of one connection or one source address
+class FloodGuard {
+public:
+    FloodGuard() = default;
+    FloodGuard(const RateLimitConfig &config, int64_t nowMs);
+
+    // Charges one frame of the given size, false and nothing charged if the budget is exhausted
+    bool admit(size_t bytes, int64_t nowMs);
+
+    // Whether admit would succeed now, charging nothing
+    bool canAdmit(size_t bytes, int64_t nowMs);
+
+    // Milliseconds until a frame of the given size would be admitted
+    int64_t millisUntilAdmit(size_t bytes, int64_t nowMs);
+
+private:
+    TokenBucket frames;
+    TokenBucket bytes;
+};
+
+enum class RateVerdict {
+    ALLOW,      // Process the frame
+    THROTTLE,   // Drop the frame and stop reading the socket for a while
+    DISCONNECT  // Too many throttles in a row
+};
+
+// Rate state kept in the connection record, freed together with it
+struct ConnectionRateState {
+    FloodGuard guard;
+    int strikes = 0;
+    int64_t lastStrikeMs = 0;
+    int64_t resumeAtMs = 0; // 0 while the socket is being read
+};
+
+// Applies per-connection and per-address limits to inbound frames
+class RateLimiter {
+public:
+    RateLimiter(const RateLimitConfig &perConnection, const RateLimitConfig &perAddress, int maxStrikes);
+
+    // Charges an accept against the address budget, false if the address has to wait
+    bool admitConnection(const std::string &address, int64_t nowMs);
+
+    ConnectionRateState openConnection(const std::string &address, int64_t nowMs);
+    void closeConnection(const std::string &address, int64_t nowMs);
+
+    RateVerdict admit(ConnectionRateState &state, const std::string &address, size_t bytes, int64_t nowMs);
+
+private:
+    // Kept for a while after the last connection closes, so reconnecting does not refill the budget
+    struct AddressState {
+        FloodGuard guard;
+        int connections = 0;
+        int64_t idleSinceMs = 0;    // When the last connection closed
+    };
+
+    AddressState &addressState(const std::string &address, int64_t nowMs);
+    void expireIdleAddresses(int64_t nowMs);
+
+    RateLimitConfig perConnection;
+    RateLimitConfig perAddress;
+    int maxStrikes;
+    std::unordered_map<std::string, AddressState> addresses;
+    std::deque<std::pair<int64_t, std::string>> idleAddresses; // Close time and address, oldest first
+};
+
+#endif // RATE_LIMITER_H
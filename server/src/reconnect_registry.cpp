@@ -0,0 +1,115 @@
+#include "reconnect_registry.h"
+#include <algorithm>
+
+void ReconnectRegistry::setGracePeriod(int seconds)
+{
+    gracePeriod = std::max(0, seconds);
+}
+
+int ReconnectRegistry::getGracePeriod() const
+{
+    return gracePeriod;
+}
+
+void ReconnectRegistry::reserve(const std::string &nickname, int sessionId, time_t now)
+{
+    // A nickname can hold only one seat at a time
+    erase(nickname);
+
+    auto deadline = deadlines.emplace(now + gracePeriod, nickname);
+    byNickname[nickname] = Reservation{sessionId, deadline};
+    bySession[sessionId].push_back(nickname);
+}
+
+bool ReconnectRegistry::claim(const std::string &nickname, int &sessionId)
+{
+    auto it = byNickname.find(nickname);
+    if (it == byNickname.end())
+    {
+        return false;
+    }
+
+    sessionId = it->second.sessionId;
+    erase(nickname);
+    return true;
+}
+
+void ReconnectRegistry::releaseSession(int sessionId)
+{
+    auto it = bySession.find(sessionId);
+    if (it == bySession.end())
+    {
+        return;
+    }
+
+    for (const auto &nickname : it->second)
+    {
+        auto reservation = byNickname.find(nickname);
+        if (reservation != byNickname.end())
+        {
+            deadlines.erase(reservation->second.deadline);
+            byNickname.erase(reservation);
+        }
+    }
+    bySession.erase(it);
+}
+
+bool ReconnectRegistry::isSessionReserved(int sessionId) const
+{
+    return bySession.find(sessionId) != bySession.end();
+}
+
+std::vector<int> ReconnectRegistry::collectExpired(time_t now)
+{
+    std::vector<int> expiredSessions;
+
+    while (!deadlines.empty() && deadlines.begin()->first <= now)
+    {
+        int sessionId = byNickname[deadlines.begin()->second].sessionId;
+
+        // The whole session is abandoned, its other reservations go with it
+        releaseSession(sessionId);
+        expiredSessions.push_back(sessionId);
+    }
+
+    return expiredSessions;
+}
+
+int ReconnectRegistry::secondsUntilNextExpiry(time_t now) const
+{
+    if (deadlines.empty())
+    {
+        return -1;
+    }
+    return std::max<time_t>(0, deadlines.begin()->first - now);
+}
+
+size_t ReconnectRegistry::size() const
+{
+    return byNickname.size();
+}
+
+void ReconnectRegistry::erase(const std::string &nickname)
+{
+    auto it = byNickname.find(nickname);
+    if (it == byNickname.end())
+    {
+        return;
+    }
+
+    int sessionId = it->second.sessionId;
+    deadlines.erase(it->second.deadline);
+    byNickname.erase(it);
+
+    // A session holds at most two seats, so this is constant time
+    auto session = bySession.find(sessionId);
+    if (session != bySession.end())
+    {
+        auto &nicknames = session->second;
+        nicknames.erase(std::remove(nicknames.begin(), nicknames.end(), nickname), nicknames.end());
+        if (nicknames.empty())
+        {
+            bySession.erase(session);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef RECONNECT_REGISTRY_H
+#define RECONNECT_REGISTRY_H
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keeps the seats of players that dropped out of a running game.
+// A seat is held for a grace period; after that the session is reported as abandoned.
+class ReconnectRegistry {
+public:
+    void setGracePeriod(int seconds);
+    int getGracePeriod() const;
+
+    // Holds the seat of nickname in sessionId until now + grace period
+    void reserve(const std::string &nickname, int sessionId, time_t now);
+
+    // Removes the reservation of nickname and returns its session in sessionId
+    bool claim(const std::string &nickname, int &sessionId);
+
+    // Drops every reservation of the session (session has ended)
+    void releaseSession(int sessionId);
+
+    bool isSessionReserved(int sessionId) const;
+
+    // Removes expired reservations and returns the sessions they belonged to
+    std::vector<int> collectExpired(time_t now);
+
+    // Seconds until the next reservation expires, -1 if there are none
+    int secondsUntilNextExpiry(time_t now) const;
+
+    size_t size() const;
+
+private:
+    struct Reservation {
+        int sessionId;
+        std::multimap<time_t, std::string>::iterator deadline;
+    };
+
+    void erase(const std::string &nickname);
+
+    int gracePeriod = 60;
+    std::unordered_map<std::string, Reservation> byNickname;        // nickname -> reservation
+    std::unordered_map<int, std::vector<std::string>> bySession;    // session -> reserved nicknames
+    std::multimap<time_t, std::string> deadlines;                   // expiry time -> nickname
+};
+
+#endif // RECONNECT_REGISTRY_H
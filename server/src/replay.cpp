@@ -0,0 +1,303 @@
+#include "replay.h"
+#include "listeners.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+const int REPLAY_MAX_EVENTS = 256;
+const int64_t REPLAY_MAX_WAIT_US = 100000;
+
+static int64_t steadyMicros()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+TraceReplayer::TraceReplayer(const ReplayConfig &replayConfig) : config(replayConfig)
+{
+}
+
+TraceReplayer::~TraceReplayer()
+{
+    for (auto &pair : connections)
+    {
+        closeConnection(pair.second);
+    }
+    if (epollFd != -1)
+    {
+        close(epollFd);
+    }
+}
+
+bool TraceReplayer::load()
+{
+    TraceReader reader;
+    if (!reader.open(config.tracePath))
+    {
+        return false;
+    }
+
+    TraceRecord record;
+    int64_t lastMs = 0;
+    while (reader.next(record))
+    {
+        if (stats.records++ == 0)
+        {
+            firstMs = record.atMs;
+        }
+        lastMs = record.atMs;
+        connections[record.connection].records.push_back(record);
+    }
+    stats.connections = connections.size();
+    stats.traceSpanMs = lastMs - firstMs;
+    return true;
+}
+
+const ReplayStats &TraceReplayer::getStats() const
+{
+    return stats;
+}
+
+int64_t TraceReplayer::elapsedUs() const
+{
+    return steadyMicros() - startedUs;
+}
+
+void TraceReplayer::run()
+{
+    epollFd = epoll_create1(0);
+    startedUs = steadyMicros();
+    for (auto &pair : connections)
+    {
+        scheduleNext(pair.first, pair.second);
+    }
+
+    while (!due.empty())
+    {
+        // Everything that is due goes out before looking at answers
+        int64_t now = elapsedUs();
+        while (!due.empty() && due.top().atUs <= now)
+        {
+            Due entry = due.top();
+            due.pop();
+            Connection &connection = connections[entry.connection];
+            if (entry.order != connection.scheduled)
+            {
+                continue; // Rescheduled since
+            }
+
+            // Hold the frame until the previous one is answered
+            int64_t answerDeadline = connection.awaitingSinceUs + config.answerTimeoutMs * 1000;
+            if (connection.socket != -1 && connection.awaitingSinceUs >= 0 && now < answerDeadline)
+            {
+                scheduleAt(entry.connection, connection, answerDeadline);
+                continue;
+            }
+
+            uint64_t id = entry.connection;
+            TraceRecord record = std::move(connection.records.front());
+            connection.records.pop_front();
+            execute(id, connection, record);
+            scheduleNext(id, connection);
+        }
+
+        int64_t waitUs = due.empty() ? 0 : std::min(REPLAY_MAX_WAIT_US, due.top().atUs - elapsedUs());
+        pollSockets(std::max<int64_t>(0, waitUs));
+    }
+
+    // Collect the answers to the last requests
+    int64_t settleUntil = elapsedUs() + config.settleMs * 1000;
+    while (!socketOwners.empty() && elapsedUs() < settleUntil)
+    {
+        pollSockets(std::min(REPLAY_MAX_WAIT_US, settleUntil - elapsedUs()));
+    }
+    stats.wallSeconds = elapsedUs() / 1e6;
+}
+
+void TraceReplayer::scheduleNext(uint64_t id, Connection &connection)
+{
+    if (connection.records.empty())
+    {
+        return;
+    }
+
+    // Captured pace scaled by the speed, but never two frames of one connection back to back
+    const TraceRecord &next = connection.records.front();
+    int64_t atUs = config.speed > 0 ? (int64_t)((next.atMs - firstMs) * 1000 / config.speed) : 0;
+    if (connection.lastSendUs >= 0)
+    {
+        atUs = std::max(atUs, connection.lastSendUs + config.minGapUs);
+    }
+    scheduleAt(id, connection, atUs);
+}
+
+void TraceReplayer::scheduleAt(uint64_t id, Connection &connection, int64_t atUs)
+{
+    connection.scheduled = nextOrder;
+    due.push({atUs, nextOrder++, id});
+}
+
+void TraceReplayer::execute(uint64_t id, Connection &connection, const TraceRecord &record)
+{
+    switch (record.type)
+    {
+    case TRACE_CONNECT:
+        connection.socket = openConnection();
+        if (connection.socket == -1)
+        {
+            stats.connectFailures++;
+            return;
+        }
+        socketOwners[connection.socket] = id;
+        connection.lastSendUs = elapsedUs();
+        connection.awaitingSinceUs = connection.lastSendUs; // The greeting counts as the first answer
+        return;
+
+    case TRACE_FRAME:
+    {
+        if (connection.socket == -1)
+        {
+            stats.framesSkipped++;
+            return;
+        }
+        connection.lastSendUs = elapsedUs();
+        if (send(connection.socket, record.payload.data(), record.payload.size(), MSG_NOSIGNAL) < 0)
+        {
+            stats.sendFailures++;
+            return;
+        }
+        stats.framesSent++;
+        stats.bytesSent += record.payload.size();
+
+        // PINGs are never answered, anything else is timed until the first byte back.
+        // A request still waiting here went unanswered and is not timed.
+        connection.awaitingSinceUs = record.payload.find("PING") == std::string::npos ? connection.lastSendUs : -1;
+        return;
+    }
+
+    case TRACE_PEER_CLOSED:
+        closeConnection(connection);
+        return;
+
+    case TRACE_CLOSED:
+        // Closes decided by the server happen again on their own
+        return;
+    }
+}
+
+int TraceReplayer::openConnection()
+{
+    int clientSocket = -1;
+    // Unix and IPv6 targets are written like the server's extra endpoints
+    ListenEndpoint endpoint;
+    bool parsed = parseListenEndpoint(config.target, 0, endpoint);
+    if (parsed && endpoint.kind == ListenEndpoint::UNIX)
+    {
+        struct sockaddr_un unix_addr = {};
+        unix_addr.sun_family = AF_UNIX;
+        strncpy(unix_addr.sun_path, endpoint.address.c_str(), sizeof(unix_addr.sun_path) - 1);
+        clientSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (clientSocket != -1 && connect(clientSocket, (struct sockaddr *)&unix_addr, sizeof(unix_addr)) != 0)
+        {
+            close(clientSocket);
+            return -1;
+        }
+    }
+    else if (parsed)
+    {
+        struct sockaddr_in6 server_addr = {};
+        server_addr.sin6_family = AF_INET6;
+        server_addr.sin6_port = htons(endpoint.port);
+        inet_pton(AF_INET6, endpoint.address.c_str(), &server_addr.sin6_addr);
+        clientSocket = socket(AF_INET6, SOCK_STREAM, 0);
+        if (clientSocket != -1 && connect(clientSocket, (struct sockaddr *)&server_addr, sizeof(server_addr)) != 0)
+        {
+            close(clientSocket);
+            return -1;
+        }
+    }
+    else
+    {
+        size_t colon = config.target.rfind(':');
+        struct sockaddr_in server_addr = {};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(atoi(config.target.c_str() + colon + 1));
+        if (colon == std::string::npos || inet_pton(AF_INET, config.target.substr(0, colon).c_str(), &server_addr.sin_addr) != 1)
+        {
+            return -1;
+        }
+        clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+        if (clientSocket != -1 && connect(clientSocket, (struct sockaddr *)&server_addr, sizeof(server_addr)) != 0)
+        {
+            close(clientSocket);
+            return -1;
+        }
+    }
+    if (clientSocket == -1)
+    {
+        return -1;
+    }
+
+    // Frames go out as captured, one send each
+    int noDelay = 1;
+    setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(clientSocket, F_SETFL, O_NONBLOCK);
+
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = clientSocket;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, clientSocket, &event);
+    return clientSocket;
+}
+
+void TraceReplayer::closeConnection(Connection &connection)
+{
+    if (connection.socket == -1)
+    {
+        return;
+    }
+    socketOwners.erase(connection.socket);
+    close(connection.socket);
+    connection.socket = -1;
+}
+
+void TraceReplayer::pollSockets(int64_t timeoutUs)
+{
+    struct epoll_event events[REPLAY_MAX_EVENTS];
+    int ready = epoll_wait(epollFd, events, REPLAY_MAX_EVENTS, (int)((timeoutUs + 999) / 1000));
+    int64_t now = elapsedUs();
+
+    char buffer[4096];
+    for (int i = 0; i < ready; ++i)
+    {
+        auto owner = socketOwners.find(events[i].data.fd);
+        if (owner == socketOwners.end())
+        {
+            continue;
+        }
+        uint64_t id = owner->second;
+        Connection &connection = connections[id];
+
+        ssize_t received = recv(connection.socket, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+        {
+            stats.serverCloses++;
+            closeConnection(connection);
+            continue;
+        }
+        stats.bytesReceived += received;
+        if (connection.awaitingSinceUs >= 0)
+        {
+            stats.latenciesUs.push_back(now - connection.awaitingSinceUs);
+            connection.awaitingSinceUs = -1;
+            scheduleNext(id, connection); // The next frame may go now
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "traffic_trace.h"
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ReplayConfig {
+    std::string tracePath;
+    std::string target = "127.0.0.1:1111"; // host:port, [ipv6]:port or unix:<path>
+    double speed = 1.0;                     // Multiple of the captured pace, 0 for as fast as possible
+    int64_t minGapUs = 1000;                // Between two frames of one connection, so the server reads them apart
+    int64_t answerTimeoutMs = 1000;         // Longest a frame waits for the answer to the previous one
+    int64_t settleMs = 1000;                // Time left for answers after the last record
+};
+
+struct ReplayStats {
+    uint64_t records = 0;
+    uint64_t connections = 0;
+    int64_t traceSpanMs = 0;
+    double wallSeconds = 0;
+    uint64_t connectFailures = 0;
+    uint64_t framesSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t framesSkipped = 0;         // Connection already gone when the frame was due
+    uint64_t sendFailures = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t serverCloses = 0;
+    std::vector<int64_t> latenciesUs;   // Request to first answer byte
+};
+
+// Re-drives a captured trace against a running server over real sockets.
+// Records of one connection are replayed in order, each frame after the answer to the previous one
+// (or answerTimeoutMs), since the protocol has no framing and back-to-back frames would be read as one.
+// Connections run interleaved; at high speeds a frame can overtake another connection's frame it
+// depended on, e.g. a guess arriving before the opponent's move, which the server answers as it would live.
+class TraceReplayer {
+public:
+    explicit TraceReplayer(const ReplayConfig &config);
+    ~TraceReplayer();
+
+    // Reads the trace into per-connection queues, false if it cannot be read
+    bool load();
+    void run();
+
+    const ReplayStats &getStats() const;
+
+private:
+    struct Connection {
+        std::deque<TraceRecord> records;
+        int socket = -1;                // -1 before the connect, after a failed one and after the close
+        int64_t lastSendUs = -1;
+        int64_t awaitingSinceUs = -1;   // Send time of the request still waiting for an answer
+        uint64_t scheduled = 0;         // Order of the connection's live entry in the due queue
+    };
+
+    struct Due {
+        int64_t atUs;
+        uint64_t order;
+        uint64_t connection;
+
+        bool operator>(const Due &other) const
+        {
+            return atUs != other.atUs ? atUs > other.atUs : order > other.order;
+        }
+    };
+
+    void scheduleNext(uint64_t id, Connection &connection);
+    void scheduleAt(uint64_t id, Connection &connection, int64_t atUs);
+    void execute(uint64_t id, Connection &connection, const TraceRecord &record);
+    int openConnection();
+    void closeConnection(Connection &connection);
+    void pollSockets(int64_t timeoutUs);
+    int64_t elapsedUs() const;
+
+    ReplayConfig config;
+    ReplayStats stats;
+    std::unordered_map<uint64_t, Connection> connections;
+    std::unordered_map<int, uint64_t> socketOwners;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> due;
+    uint64_t nextOrder = 1;
+    int64_t firstMs = 0;
+    int64_t startedUs = 0;
+    int epollFd = -1;
+};
+
+#endif // REPLAY_H
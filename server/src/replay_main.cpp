@@ -0,0 +1,88 @@
+#include "replay.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Reads --name=value options into the replay config
+static bool parseOption(const char *arg, ReplayConfig &config)
+{
+    const char *value = strchr(arg, '=');
+    if (value == nullptr)
+    {
+        return false;
+    }
+    std::string name(arg, value - arg);
+    value++;
+
+    try
+    {
+        if (name == "--trace") config.tracePath = value;
+        else if (name == "--target") config.target = value;
+        else if (name == "--speed") config.speed = strcmp(value, "max") == 0 ? 0 : std::stod(value);
+        else if (name == "--min-gap-us") config.minGapUs = std::stoll(value);
+        else if (name == "--answer-timeout-ms") config.answerTimeoutMs = std::stoll(value);
+        else if (name == "--settle-ms") config.settleMs = std::stoll(value);
+        else return false;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return config.speed >= 0;
+}
+
+static double percentileMs(const std::vector<int64_t> &sorted, double fraction)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))] / 1000.0;
+}
+
+int main(int argc, char **argv)
+{
+    ReplayConfig config;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!parseOption(argv[i], config))
+        {
+            std::cerr << "[Replay] Unknown option: " << argv[i] << "\n"
+                      << "Options: --trace=<file> --target=<host:port|[ipv6]:port|unix:path> --speed=<N|max>\n"
+                      << "         --min-gap-us= --answer-timeout-ms= --settle-ms=\n";
+            return 1;
+        }
+    }
+    if (config.tracePath.empty())
+    {
+        std::cerr << "[Replay] --trace=<file> is required\n";
+        return 1;
+    }
+
+    TraceReplayer replayer(config);
+    if (!replayer.load())
+    {
+        std::cerr << "[Replay] Cannot read trace " << config.tracePath << "\n";
+        return 1;
+    }
+    const ReplayStats &stats = replayer.getStats();
+    std::cout << "[Replay] " << stats.records << " records on " << stats.connections << " connections over "
+              << stats.traceSpanMs / 1000.0 << " s, replaying at " << (config.speed > 0 ? std::to_string(config.speed) + "x" : "max speed")
+              << " against " << config.target << std::endl;
+
+    replayer.run();
+
+    std::vector<int64_t> latencies = stats.latenciesUs;
+    std::sort(latencies.begin(), latencies.end());
+    double seconds = std::max(stats.wallSeconds, 1e-9);
+    std::cout << "[Replay] Wall time:         " << stats.wallSeconds << " s\n"
+              << "[Replay] Connections:       " << stats.connections - stats.connectFailures << " (" << stats.connectFailures << " failed, "
+              << stats.serverCloses << " closed by server)\n"
+              << "[Replay] Frames sent:       " << stats.framesSent << " (" << (uint64_t)(stats.framesSent / seconds) << " /s, "
+              << stats.bytesSent << " bytes, " << stats.framesSkipped << " skipped, " << stats.sendFailures << " failed)\n"
+              << "[Replay] Bytes received:    " << stats.bytesReceived << "\n"
+              << "[Replay] Answers timed:     " << latencies.size() << "\n"
+              << "[Replay] Latency ms:        p50 " << percentileMs(latencies, 0.5) << ", p90 " << percentileMs(latencies, 0.9)
+              << ", p99 " << percentileMs(latencies, 0.99) << ", max " << percentileMs(latencies, 1.0) << "\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "secret_source.h"
+#include <atomic>
+#include <random>
+
+namespace
+{
+
+// xoshiro256**: 32 bytes of state, a few shifts and multiplies per draw
+class SecretGenerator {
+public:
+    void seed(uint64_t value)
+    {
+        // splitmix64 spreads one word over the whole state, never all zero
+        for (uint64_t &word : state)
+        {
+            value += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next()
+    {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound) without modulo bias (Lemire's multiply and reject)
+    uint64_t below(uint64_t bound)
+    {
+        __uint128_t product = (__uint128_t)next() * bound;
+        uint64_t low = (uint64_t)product;
+        if (low < bound)
+        {
+            uint64_t threshold = -bound % bound;
+            while (low < threshold)
+            {
+                product = (__uint128_t)next() * bound;
+                low = (uint64_t)product;
+            }
+        }
+        return (uint64_t)(product >> 64);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t state[4] = {};
+};
+
+// Bumped on every seed change so each thread reseeds on its next draw
+std::atomic<uint64_t> seedEpoch{0};
+std::atomic<uint64_t> fixedSeed{0};
+std::atomic<bool> seedFixed{false};
+std::atomic<uint64_t> nextThreadOrdinal{0};
+
+struct ThreadSource {
+    SecretGenerator generator;
+    uint64_t epoch = ~0ULL;     // Never a real epoch, so the first draw seeds
+    uint64_t ordinal = nextThreadOrdinal.fetch_add(1, std::memory_order_relaxed);
+};
+
+thread_local ThreadSource threadSource;
+
+SecretGenerator &generatorForThread()
+{
+    uint64_t epoch = seedEpoch.load(std::memory_order_acquire);
+    if (threadSource.epoch != epoch)
+    {
+        if (seedFixed.load(std::memory_order_relaxed))
+        {
+            // Distinct but reproducible stream per thread
+            threadSource.generator.seed(fixedSeed.load(std::memory_order_relaxed) ^ (threadSource.ordinal * 0xd1b54a32d192ed03ULL));
+        }
+        else
+        {
+            std::random_device rd;
+            threadSource.generator.seed(((uint64_t)rd() << 32) | rd());
+        }
+        threadSource.epoch = epoch;
+    }
+    return threadSource.generator;
+}
+
+} // namespace
+
+void setSecretSeed(uint64_t seed)
+{
+    fixedSeed.store(seed, std::memory_order_relaxed);
+    seedFixed.store(true, std::memory_order_relaxed);
+    seedEpoch.fetch_add(1, std::memory_order_release);
+}
+
+void clearSecretSeed()
+{
+    seedFixed.store(false, std::memory_order_relaxed);
+    seedEpoch.fetch_add(1, std::memory_order_release);
+}
+
+std::string drawSecret(const GameVariant &variant)
+{
+    const VariantKernel &kernel = kernelFor(variant);
+    std::string number(variant.length, '0');
+    kernel.decode(generatorForThread().below(kernel.codeCount), &number[0]);
+    return number;
+}
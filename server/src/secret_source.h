@@ -0,0 +1,17 @@
+#ifndef SECRET_SOURCE_H
+#define SECRET_SOURCE_H
+
+#include "game_variant.h"
+#include <cstdint>
+#include <string>
+
+// Secrets come from a small generator per thread, seeded once on its first draw.
+// By default the seed is taken from std::random_device, so only the first session of a thread pays for entropy.
+// A fixed seed makes the sequence of secrets reproducible; every thread then derives its own stream from it.
+void setSecretSeed(uint64_t seed);
+void clearSecretSeed();
+
+// One uniform draw over all codes of the variant, decoded straight into the session's code string
+std::string drawSecret(const GameVariant &variant);
+
+#endif // SECRET_SOURCE_H
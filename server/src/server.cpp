@@ -13,34 +13,71 @@
 #include <set>
 #include <sys/resource.h>
 #include <algorithm>
-#include <random>
 #include "messages.h"
+#include "reconnect_registry.h"
+#include "rate_limiter.h"
+#include "transport.h"
+#include "player_stats.h"
+#include "game_export.h"
+#include "admin_control.h"
+#include "traffic_trace.h"
+#include "secret_source.h"
+#include "listeners.h"
 #include <unordered_map>
+#include <deque>
+#include <sstream>
 
 /*--------------------------------------------------------GLOBALS------------------------------------------------------------------------------------------------*/
 int server_socket;
+std::set<int> listenSockets;                // Every socket accepting connections, server_socket included
+std::vector<ListenEndpoint> extraEndpoints; // Unix and IPv6 endpoints served alongside the IPv4 socket
 
 const int MAX_NICKNAME_LENGTH = 20;
 char serverIPAddress[16] = "0.0.0.0"; // Default IP address (all available interfaces)
 
 int32_t SERVER_PORT = 1111; // Default value
 int MAX_CONNECTIONS = 5;    // Default value
-int8_t USER_TIMEOUT = 30;   // User timeout
+int USER_TIMEOUT = 30;      // User timeout
+int HEARTBEAT_INTERVAL = 60; // PING interval offered to clients that ask, they are dropped after two missed ones
+
+// Dead peers are found by the kernel instead of by application PINGs
+const KeepaliveConfig TCP_KEEPALIVE = {10, 5, 3, 20000}; // idle s, probe interval s, probes, user timeout ms
+int RECONNECT_GRACE_PERIOD = 60; // How long a dropped player's seat is held
 
 std::map<int, std::string> clientNicknames; // Stores socket descriptor to nickname mapping
 std::map<int, int> clientSessions;          // Stores socket descriptor to session mapping
 std::map<int, GameSession> gameSessions;    // Stores pairs of clients for each session
-std::unordered_map<std::string, int> disconnectedClients; // Map of nickname to sessionId
-
-
-enum GuessValidationCode
-{
-    VALID_GUESS = 0,
-    ERROR_NO_G_PREFIX = -1,
-    ERROR_LENGTH = -2,
-    ERROR_NOT_DIGITS = -3,
-    ERROR_NOT_UNIQUE = -4
-};
+ReconnectRegistry disconnectedClients;       // Seats held for dropped players (nickname <-> sessionId)
+int nextSessionId = 0;                      // Session ids are never reused
+std::map<int, ClientConnection> clientConnections; // Per-socket connection record, erased on close
+uint64_t nextConnectionId = 1;
+std::set<int> throttledSockets;             // Sockets temporarily removed from the read set
+
+// Inbound flood protection, checked before a message is parsed
+const RateLimitConfig CLIENT_RATE_LIMIT = {10, 20, 2048, 4096};   // frames/s, frame burst, bytes/s, byte burst
+const RateLimitConfig ADDRESS_RATE_LIMIT = {40, 80, 8192, 16384}; // Shared by all connections of one IP
+const int MAX_THROTTLE_STRIKES = 3;                               // Throttles within a minute before disconnect
+RateLimiter rateLimiter(CLIENT_RATE_LIMIT, ADDRESS_RATE_LIMIT, MAX_THROTTLE_STRIKES);
+
+TraceWriter *trafficCapture = nullptr;      // Null unless inbound traffic is being recorded
+AdminControl *adminControl = nullptr;       // Null when there is no admin endpoint
+bool draining = false;                      // No new players, the loop ends with the last connection
+volatile sig_atomic_t interruptSignal = 0;  // Set by the signal handler, the loop then shuts down like after a drain
+int signalWakePair[2] = {-1, -1};           // The handler writes to [1] so the loop leaves its wait
+std::map<time_t, std::set<int>> livenessChecks; // Sockets to look at, by the second their idle timeout could expire
+
+// Sockets and time come from here, the simulation swaps in virtual ones
+PosixTransport posixTransport;
+SystemClock systemClock;
+Transport *transport = &posixTransport;
+Clock *serverClock = &systemClock;
+
+LogLevel logLevel = LOG_DEBUG;
+
+PlayerStatsStore *playerStats = nullptr;    // Null when statistics are disabled
+GameExporter *gameExporter = nullptr;       // Null when finished games are not exported
+
+std::map<GameVariant, std::deque<int>> waitingSessions; // Sessions with one player, per variant, oldest first
 /* -------------------------------------------------------- SERVER ----------------------------------------------------------------------------------------------*/
 
 void Server::startServer()
@@ -51,9 +88,37 @@ void Server::startServer()
     initializeSocket();
     bindSocket();
     startListening();
+    openExtraListeners();
 
     // Server logic
     eventLoop();
+
+    // Reached after a drain or an interrupt, let the background writers finish
+    if (interruptSignal != 0)
+    {
+        std::cout << "[Server] Interrupt signal (" << interruptSignal << ") received, shutting down\n";
+    }
+    else
+    {
+        std::cout << "[Server] Drained, shutting down\n";
+    }
+    disableAdminControl();
+    disableGameExport();
+    disablePlayerStats();
+    disableTrafficCapture();
+
+    // Socket files would otherwise outlive the server
+    for (const ListenEndpoint &endpoint : extraEndpoints)
+    {
+        if (endpoint.kind == ListenEndpoint::UNIX)
+        {
+            unlink(endpoint.address.c_str());
+        }
+    }
+    if (interruptSignal != 0)
+    {
+        exit(interruptSignal);
+    }
 }
 
 void Server::configureServer()
@@ -99,10 +164,96 @@ void Server::configureServer()
         MAX_CONNECTIONS = getMaxSystemConnections();
         std::cout << "[Server] System limit for maximum connections is: " << MAX_CONNECTIONS << "\n";
     }
+
+    std::cout << "Enter the reconnect grace period in seconds (default is " << RECONNECT_GRACE_PERIOD << "): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        try
+        {
+            RECONNECT_GRACE_PERIOD = std::stoi(input);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "[Error] Invalid grace period: " << e.what() << ". Using " << RECONNECT_GRACE_PERIOD << " seconds.\n";
+        }
+    }
+    disconnectedClients.setGracePeriod(RECONNECT_GRACE_PERIOD);
+
+    std::cout << "Enter additional endpoints separated by spaces, e.g. unix:/tmp/bulls.sock [::]:" << SERVER_PORT
+              << " (press ENTER for none): ";
+    std::getline(std::cin, input);
+    std::istringstream endpoints(input);
+    std::string spec;
+    while (endpoints >> spec)
+    {
+        ListenEndpoint endpoint;
+        if (!parseListenEndpoint(spec, SERVER_PORT, endpoint))
+        {
+            std::cerr << "[Error] Invalid endpoint " << spec << ", ignoring it.\n";
+            continue;
+        }
+        addListenEndpoint(endpoint);
+    }
+
+    std::cout << "Enter a file for player statistics, e.g. player_stats.dat (press ENTER to disable): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        enablePlayerStats(input);
+    }
+
+    std::cout << "Enter the directory for finished game export (press ENTER to disable): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        enableGameExport(input);
+    }
+
+    std::cout << "Enter a file to capture inbound traffic to (press ENTER to disable): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        enableTrafficCapture(input);
+    }
+
+    std::cout << "Enter a fixed seed for secret numbers (press ENTER for random): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        try
+        {
+            seedSecretGenerator(std::stoull(input));
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "[Error] Invalid seed: " << e.what() << ". Secret numbers stay random.\n";
+        }
+    }
+
+    std::cout << "Enter the admin socket, e.g. unix:/tmp/bulls_admin.sock (press ENTER to disable): ";
+    std::getline(std::cin, input);
+    if (!input.empty())
+    {
+        ListenEndpoint endpoint;
+        if (!parseListenEndpoint(input, 0, endpoint) || endpoint.kind != ListenEndpoint::UNIX)
+        {
+            std::cerr << "[Error] Invalid admin endpoint " << input << ", only unix: sockets are accepted. Admin interface disabled.\n";
+        }
+        else
+        {
+            enableAdminControl(endpoint);
+        }
+    }
 }
 
 void Server::setupSignalHandler()
 {
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, signalWakePair) == 0)
+    {
+        fcntl(signalWakePair[0], F_SETFL, O_NONBLOCK);
+        fcntl(signalWakePair[1], F_SETFL, O_NONBLOCK);
+    }
     signal(SIGINT, signalHandler);
 }
 
@@ -155,82 +306,341 @@ void Server::startListening()
     std::cout << "[Server] Maximum allowed connections: " << MAX_CONNECTIONS << "\n";
 }
 
+void Server::openExtraListeners()
+{
+    // Endpoints that failed are forgotten, so shutdown never unlinks a path it did not bind
+    std::vector<ListenEndpoint> opened;
+    for (const ListenEndpoint &endpoint : extraEndpoints)
+    {
+        int listenSocket = openListenSocket(endpoint, MAX_CONNECTIONS);
+        if (listenSocket != -1)
+        {
+            listenSockets.insert(listenSocket);
+            opened.push_back(endpoint);
+            std::cout << "[Server] Also listening on " << describeListenEndpoint(endpoint) << "\n";
+        }
+    }
+    extraEndpoints.swap(opened);
+}
+
+void Server::serveOn(int listenSocket)
+{
+    server_socket = listenSocket;
+    eventLoop();
+}
+
 void Server::eventLoop()
 {
-    fd_set master_set, read_fds;
-    int fd_max = server_socket;
+    // Watch every listening socket for new connections
+    listenSockets.insert(server_socket);
+    for (int listenSocket : listenSockets)
+    {
+        transport->watch(listenSocket);
+    }
+    if (adminControl != nullptr)
+    {
+        transport->watch(adminControl->wakeSocket());
+    }
+    if (signalWakePair[0] != -1)
+    {
+        transport->watch(signalWakePair[0]);
+    }
+    std::vector<int> readySockets;
+
+    while (!draining || !clientConnections.empty())
+    {
+        // Use the transport to wait for activity on any socket, with a timeout
+        int activity = transport->wait(nextTimerDelayMs(), readySockets);
+        if (activity == WAIT_SHUTDOWN || interruptSignal != 0)
+        {
+            break;
+        }
+        if (activity == WAIT_FAILED)
+        {
+            std::cerr << "[Server] Select failed\n";
+            break;
+        }
+
+        // Handle every socket that is ready. Timers and admin commands close sockets, so they run only
+        // after this list is done; otherwise a closed socket, or a new one reusing its number, would be read here.
+        for (int i = 0; i < activity; ++i)
+        {
+            int ready = readySockets[i];
+            if (adminControl != nullptr && ready == adminControl->wakeSocket())
+            {
+                adminControl->clearWakeups(); // Commands are taken below
+            }
+            else if (ready == signalWakePair[0])
+            {
+                continue; // Only written to together with interruptSignal
+            }
+            else if (listenSockets.count(ready))
+            {
+                handleNewConnection(ready);
+            }
+            else if (clientConnections.count(ready))
+            {
+                handleClientData(ready);
+            }
+        }
 
-    // Initialize the master set and add the server socket
-    FD_ZERO(&master_set);
-    FD_SET(server_socket, &master_set);
+        handleTimers();
+        drainAdminCommands();
 
-    // To track the last activity of each client
-    std::map<int, time_t> lastActivity;
+        // Games that ended since leave their players at the nickname prompt
+        if (draining)
+        {
+            closeConnectionsOutsideGames();
+        }
+    }
+
+    for (int listenSocket : listenSockets)
+    {
+        transport->close(listenSocket);
+    }
+    listenSockets.clear();
+    if (adminControl != nullptr)
+    {
+        transport->unwatch(adminControl->wakeSocket());
+    }
+    if (signalWakePair[0] != -1)
+    {
+        transport->unwatch(signalWakePair[0]);
+    }
+}
 
-    while (true)
+int64_t Server::nextTimerDelayMs()
+{
+    // Wait at most 30 seconds, or less if an idle timeout, a held seat or a throttled socket is due sooner
+    int64_t timeoutMs = USER_TIMEOUT * 1000LL;
+    if (!livenessChecks.empty())
     {
-        read_fds = master_set;
+        timeoutMs = std::min<int64_t>(timeoutMs, std::max<int64_t>(0, (livenessChecks.begin()->first - serverClock->now()) * 1000LL));
+    }
+    int untilExpiry = disconnectedClients.secondsUntilNextExpiry(serverClock->now());
+    if (untilExpiry >= 0)
+    {
+        timeoutMs = std::min<int64_t>(timeoutMs, untilExpiry * 1000LL);
+    }
+    int64_t nowMs = monotonicMillis();
+    for (int throttled : throttledSockets)
+    {
+        timeoutMs = std::min(timeoutMs, std::max<int64_t>(0, clientConnections[throttled].rate.resumeAtMs - nowMs));
+    }
+    return timeoutMs;
+}
+
+void Server::handleTimers()
+{
+    time_t currentTime = serverClock->now();
+    checkLiveness(currentTime);
+
+    // Close games whose dropped player did not come back in time
+    expireReservations(currentTime);
 
-        // Set a timeout of 30 seconds
-        struct timeval timeout;
-        timeout.tv_sec = USER_TIMEOUT;
-        timeout.tv_usec = 0;
+    // Start reading throttled sockets again once their budget has refilled
+    resumeThrottledSockets();
+}
 
-        // Use select to wait for activity on any socket, with a timeout
-        int activity = select(fd_max + 1, &read_fds, nullptr, nullptr, &timeout);
-        if (activity == -1)
+static int idleTimeoutFor(const ClientConnection &connection)
+{
+    return connection.heartbeat ? std::max(USER_TIMEOUT, 2 * HEARTBEAT_INTERVAL) : USER_TIMEOUT;
+}
+
+static void unscheduleLivenessCheck(int client_socket, ClientConnection &connection)
+{
+    auto bucket = livenessChecks.find(connection.livenessCheckAt);
+    if (bucket != livenessChecks.end())
+    {
+        bucket->second.erase(client_socket);
+        if (bucket->second.empty())
         {
-            std::cerr << "[Server] Select failed\n";
-            break;
+            livenessChecks.erase(bucket);
         }
+    }
+    connection.livenessCheckAt = 0;
+}
+
+// Each connection has one entry, so a reused socket number never inherits the checks of the closed one
+static void scheduleLivenessCheck(int client_socket, ClientConnection &connection)
+{
+    unscheduleLivenessCheck(client_socket, connection);
+    connection.livenessCheckAt = connection.lastActivity + connection.idleTimeout + 1;
+    livenessChecks[connection.livenessCheckAt].insert(client_socket);
+}
 
-        // Check if timeout occurred
-        time_t currentTime = time(nullptr);
-        for (auto it = lastActivity.begin(); it != lastActivity.end();)
+void Server::checkLiveness(time_t currentTime)
+{
+    // Frames only stamp the connection record; a socket is looked at once per idle timeout,
+    // when its deadline comes up, and put back if it has heard from the client since
+    while (!livenessChecks.empty() && livenessChecks.begin()->first <= currentTime)
+    {
+        std::set<int> due = std::move(livenessChecks.begin()->second);
+        livenessChecks.erase(livenessChecks.begin());
+
+        for (int client_socket : due)
         {
-            if (difftime(currentTime, it->second) > USER_TIMEOUT)
+            auto it = clientConnections.find(client_socket);
+            if (it == clientConnections.end())
             {
-                // Disconnect client if inactive for more than USER_TIMEOUT seconds
-                int inactiveSocket = it->first;
-                std::cout << "[Server] Disconnecting socket " << inactiveSocket << " due to inactivity\n";
-                handleDisconnect(inactiveSocket);
-                FD_CLR(inactiveSocket, &master_set);
-                close(inactiveSocket);
-                it = lastActivity.erase(it);
+                continue; // Closed in the meantime
             }
-            else
+            it->second.livenessCheckAt = 0; // Its entry was just taken out
+            if (difftime(currentTime, it->second.lastActivity) <= it->second.idleTimeout)
             {
-                ++it;
+                scheduleLivenessCheck(client_socket, it->second);
+                continue;
             }
+
+            // Disconnect client if inactive for longer than its idle timeout
+            std::cout << "[Server] Disconnecting socket " << client_socket << " due to inactivity\n";
+            handleDisconnect(client_socket);
+            closeConnection(client_socket);
         }
+    }
+}
 
-        // Iterate through file descriptors to see which one is ready
-        for (int i = 0; i <= fd_max; ++i)
+void Server::drainAdminCommands()
+{
+    if (adminControl == nullptr)
+    {
+        return;
+    }
+    for (AdminCommand *command : adminControl->takeCommands())
+    {
+        command->reply.set_value(runAdminCommand(*command));
+        delete command;
+    }
+}
+
+std::string Server::runAdminCommand(const AdminCommand &command)
+{
+    switch (command.type)
+    {
+    case AdminCommandType::SNAPSHOT:
+        publishAdminSnapshot();
+        return "";
+
+    case AdminCommandType::KICK:
+        for (const auto &pair : clientNicknames)
         {
-            if (FD_ISSET(i, &read_fds))
+            if (pair.second == command.argument)
             {
-                if (i == server_socket)
+                int client_socket = pair.first;
+                std::cout << "[Admin] Kicking " << command.argument << " on socket " << client_socket << "\n";
+
+                // No seat is held for a kicked player; an opponent still at the table wins by forfeit
+                auto sessionIt = clientSessions.find(client_socket);
+                int sessionId = sessionIt != clientSessions.end() ? sessionIt->second : -1;
+                handleDisconnect(client_socket, true);
+                closeConnection(client_socket);
+                auto session = gameSessions.find(sessionId);
+                if (session != gameSessions.end() && !session->second.nickname2.empty() &&
+                    (session->second.player1 != -1 || session->second.player2 != -1))
                 {
-                    handleNewConnection(master_set, fd_max);
-                    lastActivity[fd_max] = time(nullptr); // Record the time of new connectioF
-                }
-                else
-                {
-                    handleClientData(i, master_set);
-                    lastActivity[i] = time(nullptr); // Update activity timestamp
+                    forfeitSession(sessionId);
                 }
+                return "kicked " + command.argument + "\n";
             }
         }
+        return "error: no connected player " + command.argument + "\n";
+
+    case AdminCommandType::DRAIN:
+        startDraining();
+        return "draining, " + std::to_string(clientConnections.size()) + " connections left\n";
+
+    case AdminCommandType::LOG_LEVEL:
+        setLogLevel(command.value ? LOG_DEBUG : LOG_INFO);
+        return "log level " + command.argument + "\n";
+
+    case AdminCommandType::IDLE_TIMEOUT:
+        setIdleTimeout(command.value);
+        return "idle timeout " + std::to_string(USER_TIMEOUT) + "s\n";
+    }
+    return "error: unknown command\n";
+}
+
+void Server::publishAdminSnapshot()
+{
+    auto snapshot = std::make_shared<ServerSnapshot>();
+    snapshot->builtAt = serverClock->now();
+    snapshot->connections = clientConnections.size();
+    snapshot->throttled = throttledSockets.size();
+    snapshot->draining = draining;
+    snapshot->logLevel = logLevel;
+    snapshot->idleTimeout = USER_TIMEOUT;
+    for (const auto &pair : clientNicknames)
+    {
+        snapshot->players += !pair.second.empty();
     }
 
-    close(server_socket);
+    for (const auto &pair : gameSessions)
+    {
+        const GameSession &session = pair.second;
+        SessionSnapshot copy;
+        copy.id = pair.first;
+        copy.variant = describeGameVariant(session.variant);
+        copy.nickname1 = session.nickname1;
+        copy.nickname2 = session.nickname2;
+        copy.player1 = session.player1;
+        copy.player2 = session.player2;
+        copy.turnsTaken = session.turnsTaken;
+        copy.reserved = disconnectedClients.isSessionReserved(pair.first);
+        copy.moves = session.moveHistory;
+        snapshot->sessions.push_back(std::move(copy));
+    }
+    adminControl->publish(snapshot);
 }
 
-void Server::handleNewConnection(fd_set &master_set, int &fd_max)
+void Server::startDraining()
 {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    int client_socket = accept(server_socket, (struct sockaddr *)&client_addr, &client_len);
+    if (draining)
+    {
+        return;
+    }
+    draining = true;
+    std::cout << "[Server] Draining: no new players, " << clientConnections.size() << " connections left\n";
+
+    // Nobody new gets in
+    for (int listenSocket : listenSockets)
+    {
+        transport->close(listenSocket);
+    }
+    listenSockets.clear();
+
+    closeConnectionsOutsideGames();
+}
+
+void Server::closeConnectionsOutsideGames()
+{
+    // Only games with two players keep a draining server alive. Connections without a nickname,
+    // players waiting for an opponent and players back at the nickname prompt after a game are let go.
+    std::vector<int> idle;
+    for (const auto &pair : clientConnections)
+    {
+        auto sessionIt = clientSessions.find(pair.first);
+        if (sessionIt == clientSessions.end())
+        {
+            idle.push_back(pair.first);
+            continue;
+        }
+        const GameSession &session = gameSessions[sessionIt->second];
+        if (session.nickname1.empty() || session.nickname2.empty())
+        {
+            idle.push_back(pair.first);
+        }
+    }
+    for (int client_socket : idle)
+    {
+        handleDisconnect(client_socket, true);
+        closeConnection(client_socket);
+    }
+}
+
+int Server::handleNewConnection(int listenSocket)
+{
+    std::string address;
+    int client_socket = transport->accept(listenSocket, address);
 
     if (client_socket == -1)
     {
@@ -238,16 +648,41 @@ void Server::handleNewConnection(fd_set &master_set, int &fd_max)
     }
     else
     {
-        // Set client socket to non-blocking
-        fcntl(client_socket, F_SETFL, O_NONBLOCK);
+        // Bots on this host running as our own user are trusted
+        bool trusted = false;
+        PeerCredentials credentials;
+        if (transport->peerCredentials(client_socket, credentials))
+        {
+            trusted = credentials.uid == geteuid();
+            std::cout << "[Server] Local peer pid " << credentials.pid << " uid " << credentials.uid
+                      << (trusted ? " (trusted)" : "") << " on socket " << client_socket << "\n";
+        }
+
+        // Reconnecting in a loop is charged like flooding
+        if (!trusted && !rateLimiter.admitConnection(address, monotonicMillis()))
+        {
+            std::cout << "[Server] " << address << " reconnects too fast. Refusing socket " << client_socket << "\n";
+            transport->close(client_socket);
+            return -1;
+        }
+
+        // Add the new client socket to the watched set
+        transport->watch(client_socket);
+        std::cout << "[Server] New connection from " << address << " on socket " << client_socket << "\n";
 
-        // Add the new client socket to the master set
-        FD_SET(client_socket, &master_set);
-        if (client_socket > fd_max)
+        ClientConnection &connection = clientConnections[client_socket];
+        connection.id = nextConnectionId++;
+        connection.address = address;
+        connection.trusted = trusted;
+        if (trafficCapture != nullptr)
         {
-            fd_max = client_socket;
+            trafficCapture->write(TRACE_CONNECT, monotonicMillis(), connection.id, address.data(), address.size());
         }
-        std::cout << "[Server] New connection from " << inet_ntoa(client_addr.sin_addr) << " on socket " << client_socket << "\n";
+        connection.rate = rateLimiter.openConnection(address, monotonicMillis());
+        connection.lastActivity = serverClock->now();
+        connection.idleTimeout = idleTimeoutFor(connection);
+        scheduleLivenessCheck(client_socket, connection);
+        transport->enableKeepalive(client_socket, TCP_KEEPALIVE);
 
         // Check if the client can reconnect to an existing session
         std::string placeholderNickname = ""; // Placeholder for now until we receive the nickname
@@ -261,13 +696,14 @@ void Server::handleNewConnection(fd_set &master_set, int &fd_max)
         // send(client_socket, SUCCESSFUL_CONNECTION.c_str(), SUCCESSFUL_CONNECTION.length(), 0);
         sendMessage(client_socket, SUCCESSFUL_CONNECTION);
     }
+    return client_socket;
 }
 
-void Server::handleClientData(int client_socket, fd_set &master_set)
+void Server::handleClientData(int client_socket)
 {
     char buffer[256];
     memset(buffer, 0, sizeof(buffer));
-    int nbytes = recv(client_socket, buffer, sizeof(buffer), 0);
+    int nbytes = transport->receive(client_socket, buffer, sizeof(buffer));
 
     // If recv returns 0 or an error, the client disconnected
     if (nbytes <= 0)
@@ -280,21 +716,119 @@ void Server::handleClientData(int client_socket, fd_set &master_set)
         {
             std::cerr << "[Server] Recv error on socket " << client_socket << "\n";
         }
-        close(client_socket);
-        FD_CLR(client_socket, &master_set);
-
         // Instead of directly erasing data, handle disconnect logic
+        if (trafficCapture != nullptr)
+        {
+            trafficCapture->write(TRACE_PEER_CLOSED, monotonicMillis(), clientConnections[client_socket].id);
+        }
         handleDisconnect(client_socket);
+        closeConnection(client_socket);
+        return;
+    }
+
+    // Any frame counts as activity, PINGs included
+    ClientConnection &connection = clientConnections[client_socket];
+    connection.lastActivity = serverClock->now();
+    if (trafficCapture != nullptr)
+    {
+        trafficCapture->write(TRACE_FRAME, monotonicMillis(), connection.id, buffer, nbytes);
+    }
+
+    handleFrame(client_socket, std::string(buffer, nbytes));
+}
+
+void Server::handleFrame(int client_socket, const std::string &frame)
+{
+    // Charge the frame against the flood limits before looking at its content
+    ClientConnection &connection = clientConnections[client_socket];
+    RateVerdict verdict = connection.trusted ? RateVerdict::ALLOW
+                                             : rateLimiter.admit(connection.rate, connection.address, frame.size(), monotonicMillis());
+    if (verdict == RateVerdict::DISCONNECT)
+    {
+        std::cout << "[Server] Socket " << client_socket << " keeps flooding. Disconnecting...\n";
+        handleDisconnect(client_socket);
+        closeConnection(client_socket);
+        return;
+    }
+    if (verdict == RateVerdict::THROTTLE)
+    {
+        std::cout << "[Server] Socket " << client_socket << " exceeded its rate limit. Throttling...\n";
+        connection.heldFrame = frame; // Already read, it may be a real guess
+        transport->unwatch(client_socket);
+        throttledSockets.insert(client_socket);
+        return;
     }
+
     // Otherwise, we received data from the client
-    else
+    processClientMessage(client_socket, frame);
+}
+
+void Server::resumeThrottledSockets()
+{
+    int64_t nowMs = monotonicMillis();
+    std::vector<int> resumed;
+    for (auto it = throttledSockets.begin(); it != throttledSockets.end();)
+    {
+        ClientConnection &connection = clientConnections[*it];
+        if (connection.rate.resumeAtMs <= nowMs)
+        {
+            connection.rate.resumeAtMs = 0;
+            transport->watch(*it);
+            resumed.push_back(*it);
+            it = throttledSockets.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // The held frames go first, they can throttle or close their connection again
+    for (int client_socket : resumed)
     {
-        processClientMessage(client_socket, std::string(buffer), master_set);
+        auto it = clientConnections.find(client_socket);
+        if (it != clientConnections.end() && !it->second.heldFrame.empty())
+        {
+            std::string frame;
+            frame.swap(it->second.heldFrame);
+            handleFrame(client_socket, frame);
+        }
     }
 }
 
-void Server::processClientMessage(int client_socket, const std::string &message, fd_set &master_set)
+void Server::closeConnection(int client_socket)
 {
+    transport->close(client_socket);
+
+    // Drop the connection record together with its rate limiter state
+    auto it = clientConnections.find(client_socket);
+    if (it != clientConnections.end())
+    {
+        if (trafficCapture != nullptr)
+        {
+            trafficCapture->write(TRACE_CLOSED, monotonicMillis(), it->second.id);
+        }
+        rateLimiter.closeConnection(it->second.address, monotonicMillis());
+        unscheduleLivenessCheck(client_socket, it->second);
+        clientConnections.erase(it);
+    }
+    throttledSockets.erase(client_socket);
+}
+
+void Server::processClientMessage(int client_socket, const std::string &rawMessage)
+{
+    std::string message = rawMessage;
+    if (message.compare(0, HEARTBEAT_REQUEST.size(), HEARTBEAT_REQUEST) == 0)
+    {
+        // Clients send the request right after connecting, it may share the frame with their nickname
+        negotiateHeartbeat(client_socket);
+        message.erase(0, HEARTBEAT_REQUEST.size());
+        if (message.empty())
+        {
+            return;
+        }
+    }
+
     if (isPingMessage(message))
     {
         return;
@@ -306,7 +840,7 @@ void Server::processClientMessage(int client_socket, const std::string &message,
     }
     else
     {
-        handleGameMessage(client_socket, message, master_set);
+        handleGameMessage(client_socket, message);
     }
     logSessionStatus();
 
@@ -319,9 +853,39 @@ bool Server::isPingMessage(const std::string &message)
     return message.find("PING") != std::string::npos;
 }
 
+void Server::negotiateHeartbeat(int client_socket)
+{
+    // The kernel watches for dead peers, so the client only has to show it is still there now and then
+    ClientConnection &connection = clientConnections[client_socket];
+    connection.heartbeat = true;
+    connection.idleTimeout = idleTimeoutFor(connection);
+    sendMessage(client_socket, HEARTBEAT_PREFIX + std::to_string(HEARTBEAT_INTERVAL) + "\n");
+}
+
 void Server::handleNicknameSetup(int client_socket, const std::string &rawMessage)
 {
-    std::string nickname = sanitizeNickname(rawMessage);
+    // A draining server starts no new games
+    if (draining)
+    {
+        closeConnection(client_socket);
+        return;
+    }
+
+    // "nickname#V5RH" asks for a game variant, a plain nickname plays the classic game
+    std::string request = trimTrailingNewline(rawMessage);
+    GameVariant variant;
+    size_t separator = request.find(VARIANT_SEPARATOR);
+    if (separator != std::string::npos)
+    {
+        if (!parseGameVariant(request.substr(separator + 1), variant))
+        {
+            sendMessage(client_socket, INVALID_VARIANT);
+            return;
+        }
+        request.erase(separator);
+    }
+
+    std::string nickname = sanitizeNickname(request);
     if (nickname.empty())
     {
         return;
@@ -335,32 +899,37 @@ void Server::handleNicknameSetup(int client_socket, const std::string &rawMessag
     {
         clientNicknames[client_socket] = nickname;
         std::cout << "[Server] Client on socket " << client_socket << " set nickname: " << nickname << "\n";
+
+        // Lock-free read of the player's record, the file is written by another thread
+        PlayerStats stats;
+        if (playerStats != nullptr && playerStats->lookup(nickname, stats))
+        {
+            std::cout << "[Server] " << nickname << " has rating " << stats.rating << " after " << stats.games << " games\n";
+        }
         sendMessage(client_socket, NICKNAME_SET);
-        assignClientToSession(client_socket);
+        assignClientToSession(client_socket, variant);
     }
 }
 
-void Server::handleGameMessage(int client_socket, const std::string &rawMessage, fd_set &master_set)
+void Server::handleGameMessage(int client_socket, const std::string &rawMessage)
 {
     std::string procMessage = trimTrailingNewline(rawMessage);
 
     int sessionId = clientSessions[client_socket];
-    static std::map<int, int> wrongTurnAttempts; // Tracks the number of wrong turn attempts per client
-    
+    int &wrongTurnAttempts = clientConnections[client_socket].wrongTurnAttempts; // Freed with the connection
+
     GameSession &session = gameSessions[sessionId];
 
     if (!isPlayerTurn(client_socket, session) || session.player1 == -1 || session.player2 == -1)
     {
-        wrongTurnAttempts[client_socket]++;
+        wrongTurnAttempts++;
         std::cout << "[Server] Received wrong message from socket " << client_socket << "\n";
 
-        if (wrongTurnAttempts[client_socket] >= 3) {
+        if (wrongTurnAttempts >= 3) {
             std::cout << "[Server] Client on socket " << client_socket << " exceeded wrong turn limit. Disconnecting...\n";
             sendMessage(client_socket, WRONG_FORMAT);
             handleDisconnect(client_socket, false);
-            FD_CLR(client_socket, &master_set);
-            close(client_socket);
-            wrongTurnAttempts.erase(client_socket);
+            closeConnection(client_socket);
             return;
         }
 
@@ -369,19 +938,18 @@ void Server::handleGameMessage(int client_socket, const std::string &rawMessage,
     }
 
     // Reset the wrong turn counter if the player makes a valid move
-    wrongTurnAttempts[client_socket] = 0;
+    wrongTurnAttempts = 0;
 
     std::cout << "[Server] Received message from socket " << client_socket << ": " << procMessage << "\n";
 
-    int validationCode = isValidGuess(procMessage);
+    int validationCode = isValidGuess(procMessage, session);
     if (validationCode != VALID_GUESS)
     {
         if (validationCode == ERROR_NO_G_PREFIX)
         {
             sendMessage(client_socket, WRONG_FORMAT);
             handleDisconnect(client_socket);
-            FD_CLR(client_socket, &master_set);
-            close(client_socket);
+            closeConnection(client_socket);
             return;
         }
         else
@@ -391,9 +959,7 @@ void Server::handleGameMessage(int client_socket, const std::string &rawMessage,
         }
     }
 
-    std::string guessDigits = procMessage.substr(1);
-
-    auto result = calculateBullsAndCows(guessDigits, session.secretNumber);
+    auto result = session.kernel->score(procMessage.c_str() + 1, session.secretNumber.c_str());
     //================================================VALID GUESS RESPONSE
     std::string response = procMessage +
                            "B" + std::to_string(result.first) +
@@ -402,12 +968,27 @@ void Server::handleGameMessage(int client_socket, const std::string &rawMessage,
     session.moveHistory.push_back(response);
     sendToBothPlayers(session, response);
 
-    if (result.first == 4)
+    if (session.log)
+    {
+        uint8_t seat = (client_socket == session.player1) ? 1 : 2;
+        session.log->moves.push_back({procMessage.substr(1), seat, (uint8_t)result.first, (uint8_t)result.second,
+                                      monotonicMillis() - session.log->startMs});
+    }
+
+    if (result.first == session.variant.length)
     {
         handleWinCondition(client_socket, session);
         return;
     }
 
+    // Out of turns without a winner
+    session.turnsTaken++;
+    if (session.variant.maxTurns > 0 && session.turnsTaken >= session.variant.maxTurns)
+    {
+        handleDrawCondition(session);
+        return;
+    }
+
     switchPlayerTurn(session);
 }
 
@@ -451,25 +1032,15 @@ bool Server::isPlayerTurn(int client_socket, const GameSession &session)
     return (client_socket == session.currentTurn);
 }
 
-int Server::isValidGuess(const std::string &guess)
+int Server::isValidGuess(const std::string &guess, const GameSession &session)
 {
     if (guess.empty() || guess[0] != 'G')
     {
         return ERROR_NO_G_PREFIX;
     }
 
-    std::string digitsPart = guess.substr(1);
-
-    if (digitsPart.length() != 4)
-        return ERROR_LENGTH;
-    if (!std::all_of(digitsPart.begin(), digitsPart.end(), ::isdigit))
-        return ERROR_NOT_DIGITS;
-
-    std::set<char> digitsSet(digitsPart.begin(), digitsPart.end());
-    if (digitsSet.size() != 4)
-        return ERROR_NOT_UNIQUE;
-
-    return VALID_GUESS;
+    // Length, alphabet and uniqueness are checked by the session's kernel
+    return session.kernel->validate(guess.c_str() + 1, guess.size() - 1);
 }
 
 void Server::handleWinCondition(int winner_socket, GameSession &session)
@@ -478,6 +1049,19 @@ void Server::handleWinCondition(int winner_socket, GameSession &session)
 
     int opponent_socket = (session.player1 == winner_socket) ? session.player2 : session.player1;
 
+    // Players alternate turns and the winner made the last guess
+    GameResult result;
+    result.winner = (session.player1 == winner_socket) ? session.nickname1 : session.nickname2;
+    result.loser = (session.player1 == winner_socket) ? session.nickname2 : session.nickname1;
+    result.winnerGuesses = (session.moveHistory.size() + 1) / 2;
+    recordGameResult(result);
+
+    if (session.log)
+    {
+        session.log->outcome = OUTCOME_WIN;
+        session.log->winner = (session.player1 == winner_socket) ? 1 : 2;
+    }
+
     sendMessage(winner_socket, WIN_MSG);
 
     sendMessage(opponent_socket, LOST_MSG);
@@ -489,6 +1073,31 @@ void Server::handleWinCondition(int winner_socket, GameSession &session)
     handleDisconnect(opponent_socket, true);
 }
 
+void Server::handleDrawCondition(GameSession &session)
+{
+    std::cout << "[Server] Turn limit of " << session.variant.maxTurns << " reached, the game is a draw" << std::endl;
+
+    int player1 = session.player1;
+    int player2 = session.player2;
+
+    GameResult result;
+    result.winner = session.nickname1;
+    result.loser = session.nickname2;
+    result.draw = true;
+    recordGameResult(result);
+
+    if (session.log)
+    {
+        session.log->outcome = OUTCOME_DRAW;
+    }
+
+    sendToBothPlayers(session, DRAW_MSG);
+    sendToBothPlayers(session, ENDGAME_MSG);
+
+    handleDisconnect(player1, true);
+    handleDisconnect(player2, true);
+}
+
 void Server::switchPlayerTurn(GameSession &session)
 {
     session.currentTurn = (session.currentTurn == session.player1) ? session.player2 : session.player1;
@@ -505,7 +1114,7 @@ void Server::switchPlayerTurn(GameSession &session)
 
 void Server::sendMessage(int socket, const std::string &message)
 {
-    send(socket, message.c_str(), message.length(), 0);
+    transport->send(socket, message.c_str(), message.length());
 }
 
 void Server::sendToBothPlayers(const GameSession &session, const std::string &message)
@@ -529,11 +1138,11 @@ void Server::handleDisconnect(int client_socket, bool endgame)
             sendMessage(opponent_socket, OPPONENT_DISCONNECTED);
         }
 
-        // Save the nickname and sessionId to disconnectedClients if session is still active
+        // Hold the seat for the player if the session is still active
         std::string nickname = clientNicknames[client_socket];
-        if (opponent_socket != -1)
+        if (!endgame && opponent_socket != -1)
         {
-            disconnectedClients[nickname] = sessionId; // Save the disconnected client's data
+            disconnectedClients.reserve(nickname, sessionId, serverClock->now());
         }
 
         // Remove the disconnected player from the session
@@ -550,20 +1159,11 @@ void Server::handleDisconnect(int client_socket, bool endgame)
         if (session.player1 == -1 && session.player2 == -1)
         {
             std::cout << "[Server] Both players have disconnected. Removing session " << sessionId << "\n";
+            exportGameLog(session);
             gameSessions.erase(sessionId);
 
-            // Remove both players from the disconnectedClients map
-            for (auto it = disconnectedClients.begin(); it != disconnectedClients.end(); )
-            {
-                if (it->second == sessionId)
-                {
-                    it = disconnectedClients.erase(it); // Erase and get the next iterator
-                }
-                else
-                {
-                    ++it;
-                }
-            }
+            // Nobody can rejoin a removed session
+            disconnectedClients.releaseSession(sessionId);
         }
 
 
@@ -574,43 +1174,223 @@ void Server::handleDisconnect(int client_socket, bool endgame)
 
     logSessionStatus();
 }
-/* ------------------------------------------------------------ UTIL FUNCTIONS ---------------------------------------------------------------------*/
-std::string generateSecretNumber()
-{
-    std::string number;
-    std::random_device rd;                      // Obtain a random seed from hardware
-    std::mt19937 gen(rd());                     // Seed the generator
-    std::uniform_int_distribution<> dist(0, 9); // Define the range [0, 9]
 
-    while (number.length() < 4)
+void Server::expireReservations(time_t currentTime)
+{
+    for (int sessionId : disconnectedClients.collectExpired(currentTime))
     {
-        char digit = '0' + dist(gen);
-        // Ensure all digits are unique
-        if (number.find(digit) == std::string::npos)
+        auto it = gameSessions.find(sessionId);
+        if (it == gameSessions.end())
         {
-            number += digit;
+            continue;
         }
+
+        std::cout << "[Server] Reconnect grace period expired for session " << sessionId << "\n";
+        forfeitSession(sessionId);
     }
-    return number;
 }
 
-std::pair<int, int> calculateBullsAndCows(const std::string &guess, const std::string &secret)
+void Server::forfeitSession(int sessionId)
 {
-    int bulls = 0, cows = 0;
+    GameSession &session = gameSessions[sessionId];
+
+    // The player who stayed wins by forfeit
+    GameResult result;
+    result.winner = (session.player1 != -1) ? session.nickname1 : session.nickname2;
+    result.loser = (session.player1 != -1) ? session.nickname2 : session.nickname1;
+    recordGameResult(result);
 
-    for (int i = 0; i < guess.size(); ++i)
+    if (session.log)
     {
-        if (guess[i] == secret[i])
-        {
-            bulls++;
-        }
-        else if (secret.find(guess[i]) != std::string::npos)
+        session.log->outcome = OUTCOME_FORFEIT;
+        session.log->winner = (session.player1 != -1) ? 1 : 2;
+    }
+
+    int players[2] = {session.player1, session.player2};
+    for (int player : players)
+    {
+        if (player != -1)
         {
-            cows++;
+            sendMessage(player, WIN_MSG);
+            sendMessage(player, ENDGAME_MSG);
+            handleDisconnect(player, true);
         }
     }
 
-    return {bulls, cows};
+    // Nobody left to notify, just free the session
+    gameSessions.erase(sessionId);
+    disconnectedClients.releaseSession(sessionId);
+}
+/* ------------------------------------------------------------ UTIL FUNCTIONS ---------------------------------------------------------------------*/
+int64_t monotonicMillis()
+{
+    return serverClock->nowMillis();
+}
+
+void setTransport(Transport *newTransport)
+{
+    transport = newTransport;
+}
+
+void setClock(Clock *newClock)
+{
+    serverClock = newClock;
+}
+
+void setLogLevel(LogLevel level)
+{
+    logLevel = level;
+}
+
+void setReconnectGracePeriod(int seconds)
+{
+    RECONNECT_GRACE_PERIOD = seconds;
+    disconnectedClients.setGracePeriod(seconds);
+}
+
+bool enablePlayerStats(const std::string &path)
+{
+    PlayerStatsStore *store = new PlayerStatsStore();
+    if (!store->open(path))
+    {
+        std::cerr << "[Server] Cannot open player statistics " << path << ", playing without them\n";
+        delete store;
+        return false;
+    }
+    playerStats = store;
+    std::cout << "[Server] Player statistics: " << playerStats->playerCount() << " players in " << path << "\n";
+
+    for (const PlayerStats &stats : playerStats->topPlayers(5))
+    {
+        std::cout << "[Server]   " << stats.nickname << " " << stats.rating << " (" << stats.wins << "/" << stats.games << " won)\n";
+    }
+    return true;
+}
+
+void disablePlayerStats()
+{
+    // The destructor applies whatever is still queued
+    delete playerStats;
+    playerStats = nullptr;
+}
+
+void recordGameResult(const GameResult &result)
+{
+    // Only queued here, the store applies results off the game loop
+    if (playerStats != nullptr)
+    {
+        playerStats->record(result);
+    }
+}
+
+bool enableAdminControl(const ListenEndpoint &endpoint)
+{
+    // Operators are not authenticated beyond their credentials, which only a unix socket carries
+    if (endpoint.kind != ListenEndpoint::UNIX)
+    {
+        std::cerr << "[Server] The admin interface only listens on unix: sockets, not " << describeListenEndpoint(endpoint) << "\n";
+        return false;
+    }
+
+    AdminControl *control = new AdminControl();
+    if (!control->start(endpoint))
+    {
+        std::cerr << "[Server] Cannot open the admin endpoint " << describeListenEndpoint(endpoint) << "\n";
+        delete control;
+        return false;
+    }
+    adminControl = control;
+    std::cout << "[Server] Admin interface on " << describeListenEndpoint(endpoint) << "\n";
+    return true;
+}
+
+void disableAdminControl()
+{
+    delete adminControl;
+    adminControl = nullptr;
+}
+
+void setIdleTimeout(int seconds)
+{
+    USER_TIMEOUT = seconds;
+
+    // A shorter timeout has to be looked at before the checks already scheduled
+    for (auto &pair : clientConnections)
+    {
+        pair.second.idleTimeout = idleTimeoutFor(pair.second);
+        scheduleLivenessCheck(pair.first, pair.second);
+    }
+}
+
+bool enableTrafficCapture(const std::string &path)
+{
+    TraceWriter *writer = new TraceWriter();
+    if (!writer->open(path))
+    {
+        std::cerr << "[Server] Cannot create traffic capture " << path << "\n";
+        delete writer;
+        return false;
+    }
+    trafficCapture = writer;
+    std::cout << "[Server] Capturing inbound traffic to " << path << "\n";
+    return true;
+}
+
+void disableTrafficCapture()
+{
+    delete trafficCapture;
+    trafficCapture = nullptr;
+}
+
+void addListenEndpoint(const ListenEndpoint &endpoint)
+{
+    extraEndpoints.push_back(endpoint);
+}
+
+bool enableGameExport(const std::string &directory)
+{
+    GameExporter *exporter = new GameExporter();
+    if (!exporter->start(directory))
+    {
+        std::cerr << "[Server] Cannot export finished games to " << directory << ", export disabled\n";
+        delete exporter;
+        return false;
+    }
+    gameExporter = exporter;
+    std::cout << "[Server] Exporting finished games to " << directory << "\n";
+    return true;
+}
+
+void disableGameExport()
+{
+    // The destructor writes whatever is still queued
+    if (gameExporter != nullptr && gameExporter->droppedGames() > 0)
+    {
+        std::cerr << "[Server] " << gameExporter->droppedGames() << " finished games were dropped by the export\n";
+    }
+    delete gameExporter;
+    gameExporter = nullptr;
+}
+
+void exportGameLog(GameSession &session)
+{
+    // Lobbies that never got a second player are not games
+    if (gameExporter == nullptr || !session.log || session.log->startedAt == 0)
+    {
+        return;
+    }
+    session.log->endMs = monotonicMillis();
+    gameExporter->submit(session.log.release());
+}
+
+void seedSecretGenerator(uint64_t seed)
+{
+    setSecretSeed(seed);
+}
+
+std::string generateSecretNumber(const GameVariant &variant)
+{
+    return drawSecret(variant);
 }
 
 // Function to get system limit for maximum connections
@@ -629,9 +1409,16 @@ int getMaxSystemConnections()
 
 void signalHandler(int signum)
 {
-    std::cout << "Interrupt signal (" << signum << ") received. Closing server socket..." << std::endl;
-    close(server_socket);
-    exit(signum);
+    // Only async-signal-safe calls here. The event loop wakes up and shuts down like after a drain,
+    // so finished games still in the export queue reach their file; a second interrupt kills the server.
+    interruptSignal = signum;
+    signal(signum, SIG_DFL);
+    if (signalWakePair[1] != -1)
+    {
+        char wake = 1;
+        ssize_t ignored = write(signalWakePair[1], &wake, 1);
+        (void)ignored;
+    }
 }
 
 // Function to get the IP address of the server
@@ -672,6 +1459,11 @@ std::string getIPAddress()
 
 void logSessionStatus()
 {
+    if (logLevel < LOG_DEBUG)
+    {
+        return;
+    }
+
     std::cout << "===== Current Session Status =====" << std::endl;
 
     for (const auto &session : gameSessions)
@@ -681,34 +1473,42 @@ void logSessionStatus()
         std::cout << " - Player 1 Socket: " << currentSession.player1 << (currentSession.player1 != -1 ? " (Connected)" : " (Disconnected)") << std::endl;
         std::cout << " - Player 2 Socket: " << currentSession.player2 << (currentSession.player2 != -1 ? " (Connected)" : " (Disconnected)") << std::endl;
         std::cout << " - Current Turn: " << (currentSession.currentTurn == currentSession.player1 ? "Player 1" : "Player 2") << std::endl;
+        std::cout << " - Variant: " << describeGameVariant(currentSession.variant) << std::endl;
         std::cout << " - Secret Number: " << currentSession.secretNumber << std::endl;
     }
 
     std::cout << "==================================" << std::endl;
 }
 
-void assignClientToSession(int client_socket)
+void assignClientToSession(int client_socket, const GameVariant &variant)
 {
     std::string clientNickname = clientNicknames[client_socket];
     bool sessionAssigned = false;
 
-    // Check if the client is in the disconnectedClients map
-    if (disconnectedClients.find(clientNickname) != disconnectedClients.end())
+    // Check if the client has a seat held in a running session
+    int sessionId;
+    if (disconnectedClients.claim(clientNickname, sessionId))
     {
-        int sessionId = disconnectedClients[clientNickname]; // Retrieve session ID
         GameSession &session = gameSessions[sessionId];
 
         if (session.player1 == -1)
         {
             session.player1 = client_socket;
+            session.nickname1 = clientNickname;
         }
         else
         {
             session.player2 = client_socket;
+            session.nickname2 = clientNickname;
+        }
+
+        // If it was the dropped player's turn, it still points at the old socket
+        if (session.currentTurn != session.player1 && session.currentTurn != session.player2)
+        {
+            session.currentTurn = client_socket;
         }
 
         clientSessions[client_socket] = sessionId; // Map client socket to session ID
-        disconnectedClients.erase(clientNickname); // Remove from disconnectedClients
         sessionAssigned = true;
 
         // Notify the reconnected player and send the move history
@@ -716,72 +1516,91 @@ void assignClientToSession(int client_socket)
 
         for (const auto &move : session.moveHistory)
         {
-            send(client_socket, move.c_str(), move.length(), 0);
+            transport->send(client_socket, move.c_str(), move.length());
         }
 
         // Notify about turns
         int currentTurnPlayer = session.currentTurn;
-        send(currentTurnPlayer, UR_TURN.c_str(), UR_TURN.length(), 0);
+        transport->send(currentTurnPlayer, UR_TURN.c_str(), UR_TURN.length());
 
         int opponentPlayer = (currentTurnPlayer == session.player1) ? session.player2 : session.player1;
         if (opponentPlayer != -1)
         {
-            send(opponentPlayer, OPP_TURN.c_str(), OPP_TURN.length(), 0);
+            transport->send(opponentPlayer, OPP_TURN.c_str(), OPP_TURN.length());
         }
     }
     else
     {
-        // Check for an existing session with only one active player
-        for (auto &session : gameSessions)
+        // Join the oldest session waiting for the same variant
+        std::deque<int> &waiting = waitingSessions[variant];
+        while (!waiting.empty() && !sessionAssigned)
         {
-            // Ensure the session is not in the list of disconnectedClients
-            bool sessionInDisconnectedClients = false;
-            for (const auto &disconnectedPair : disconnectedClients)
+            int sessionId = waiting.front();
+            waiting.pop_front();
+
+            // Entries of sessions that ended or already started are dropped here
+            auto session = gameSessions.find(sessionId);
+            if (session == gameSessions.end() || disconnectedClients.isSessionReserved(sessionId) ||
+                session->second.player1 == -1 || session->second.player2 != -1)
             {
-                if (disconnectedPair.second == session.first)
-                {
-                    sessionInDisconnectedClients = true;
-                    break;
-                }
+                continue;
             }
 
-            if (!sessionInDisconnectedClients && session.second.player1 != -1 && session.second.player2 == -1)
+            session->second.player2 = client_socket; // Assign the client to player2
+            session->second.nickname2 = clientNickname;
+            if (session->second.log)
             {
-                session.second.player2 = client_socket; // Assign the client to player2
-                clientSessions[client_socket] = session.first;
-                sessionAssigned = true;
-
-                std::cout << "[Server] Client on socket " << client_socket << " joined session " << session.first << " as player2\n";
+                session->second.log->player2 = clientNickname;
+                session->second.log->startedAt = serverClock->now();
+                session->second.log->startMs = monotonicMillis();
+            }
+            clientSessions[client_socket] = sessionId;
+            sessionAssigned = true;
 
-                // Notify the players about the game start
-                send(session.second.player1, GAME_START.c_str(), GAME_START.length(), 0);
-                send(client_socket, GAME_START.c_str(), GAME_START.length(), 0);
+            std::cout << "[Server] Client on socket " << client_socket << " joined session " << sessionId << " as player2\n";
 
-                // Set the initial turn
-                session.second.currentTurn = session.second.player1;
+            // Notify the players about the game start
+            transport->send(session->second.player1, GAME_START.c_str(), GAME_START.length());
+            transport->send(client_socket, GAME_START.c_str(), GAME_START.length());
 
-                send(session.second.player1, UR_TURN.c_str(), UR_TURN.length(), 0);
-                send(client_socket, OPP_TURN.c_str(), OPP_TURN.length(), 0);
+            // Set the initial turn
+            session->second.currentTurn = session->second.player1;
 
-                break;
-            }
+            transport->send(session->second.player1, UR_TURN.c_str(), UR_TURN.length());
+            transport->send(client_socket, OPP_TURN.c_str(), OPP_TURN.length());
         }
 
         // If no existing session is available, create a new session
         if (!sessionAssigned)
         {
-            int newSessionId = gameSessions.size();
+            int newSessionId = nextSessionId++;
             GameSession newSession;
             newSession.player1 = client_socket;
+            newSession.nickname1 = clientNickname;
             newSession.currentTurn = client_socket;
-            newSession.secretNumber = generateSecretNumber();
+            newSession.variant = variant;
+            newSession.kernel = &kernelFor(variant);
+            newSession.secretNumber = generateSecretNumber(variant);
+            if (gameExporter != nullptr)
+            {
+                newSession.log.reset(new GameLog());
+                newSession.log->gameId = newSessionId;
+                newSession.log->variant = describeGameVariant(variant);
+                newSession.log->secret = newSession.secretNumber;
+                newSession.log->player1 = clientNickname;
+            }
 
-            gameSessions[newSessionId] = newSession;
+            gameSessions[newSessionId] = std::move(newSession);
             clientSessions[client_socket] = newSessionId;
+            waiting.push_back(newSessionId);
 
-            std::cout << "[Server] New game session " << newSessionId << " created for client " << client_socket << "\n";
+            std::cout << "[Server] New " << describeGameVariant(variant) << " game session " << newSessionId << " created for client " << client_socket << "\n";
             std::cout << "[Server] Waiting for a second player to join session " << newSessionId << "\n";
         }
+        else if (waiting.empty())
+        {
+            waitingSessions.erase(variant);
+        }
     }
 
     logSessionStatus();
@@ -1,17 +1,53 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+#include <cstdint>
+#include <ctime>
+#include <memory>
 #include <string>
 #include <vector>
+#include "admin_control.h"
+#include "game_export.h"
+#include "game_variant.h"
+#include "listeners.h"
+#include "player_stats.h"
+#include "rate_limiter.h"
+#include "traffic_trace.h"
+#include "transport.h"
+
+enum LogLevel {
+    LOG_INFO = 0,   // Connection and game events
+    LOG_DEBUG = 1   // Also dumps every session after each message
+};
 
 // Structure to represent a game session
 struct GameSession {
     int player1 = -1;
     int player2 = -1;
+    std::string nickname1;     // Seat owners, kept while a player is away
+    std::string nickname2;
     std::string secretNumber;  // The secret number to guess
     int currentTurn = -1;  // Indicates which player's turn it is: player1 or player2
     std::vector<std::string> moveHistory; // History of valid moves (responses)
+    GameVariant variant;   // Rules chosen at matchmaking
+    const VariantKernel *kernel = &kernelFor(GameVariant()); // Validation and scoring compiled for the variant
+    int turnsTaken = 0;    // Valid guesses so far, for the variant's turn limit
+    std::unique_ptr<GameLog> log; // Record for the export, null when export is disabled
+};
+// Per-socket connection record, lives from accept to close
+struct ClientConnection {
+    uint64_t id = 0;            // Never reused, unlike the socket
+    std::string address;        // Peer IP address
+    ConnectionRateState rate;   // Inbound flood limiter state
+    int wrongTurnAttempts = 0;  // Messages sent out of turn in a row
+    bool trusted = false;       // Local peer running as the server's user, exempt from rate limits
+    time_t lastActivity = 0;    // Second of the last received frame
+    bool heartbeat = false;     // Negotiated the long heartbeat interval
+    int idleTimeout = 0;        // Seconds of silence before the server drops the connection
+    time_t livenessCheckAt = 0; // Second of its one entry in the liveness checks, 0 if none
+    std::string heldFrame;      // Frame that got the connection throttled, processed when reading resumes
 };
+
 // Server class definition
 class Server {
 private:
@@ -24,33 +60,69 @@ public:
     void initializeSocket();
     void bindSocket();
     void startListening();
+    void openExtraListeners();
+    void serveOn(int listenSocket);
     void eventLoop();
-    void handleNewConnection(fd_set &master_set, int &fd_max);
-    void handleClientData(int client_socket, fd_set &master_set);
-    void processClientMessage(int client_socket, const std::string &message, fd_set &master_set);
+    int64_t nextTimerDelayMs();
+    void handleTimers();
+    void checkLiveness(time_t currentTime);
+    void drainAdminCommands();
+    std::string runAdminCommand(const AdminCommand &command);
+    void publishAdminSnapshot();
+    void startDraining();
+    void closeConnectionsOutsideGames();
+    int handleNewConnection(int listenSocket);
+    void handleClientData(int client_socket);
+    void handleFrame(int client_socket, const std::string &frame);
+    void resumeThrottledSockets();
+    void closeConnection(int client_socket);
+    void processClientMessage(int client_socket, const std::string &message);
     bool isPingMessage(const std::string &message);
+    void negotiateHeartbeat(int client_socket);
     void handleNicknameSetup(int client_socket, const std::string &rawMessage);
-    void handleGameMessage(int client_socket, const std::string &rawMessage, fd_set &master_set);
+    void handleGameMessage(int client_socket, const std::string &rawMessage);
     std::string trimTrailingNewline(const std::string &message);
     std::string sanitizeNickname(const std::string &raw);
     bool isNicknameInUse(const std::string &nickname);
     bool isPlayerTurn(int client_socket, const GameSession &session);
-    int isValidGuess(const std::string &guess);
+    int isValidGuess(const std::string &guess, const GameSession &session);
     void handleWinCondition(int winner_socket, GameSession &session);
+    void handleDrawCondition(GameSession &session);
     void switchPlayerTurn(GameSession &session);
     void sendMessage(int socket, const std::string &message);
     void sendToBothPlayers(const GameSession &session, const std::string &message);
     void handleDisconnect(int client_socket, bool endgame=false);
+    void expireReservations(time_t currentTime);
+    void forfeitSession(int sessionId);
 };
 
 std::string getIPAddress();
+int64_t monotonicMillis();
 void logSessionStatus();
 int getMaxSystemConnections();
 void signalHandler(int signum);
-std::pair<int, int> calculateBullsAndCows(const std::string& guess, const std::string& secret);
-std::string generateSecretNumber();
+std::string generateSecretNumber(const GameVariant &variant);
+
+// Runtime hooks, used by the simulation to replace sockets, time and randomness
+void setTransport(Transport *transport);
+void setClock(Clock *clock);
+void setLogLevel(LogLevel level);
+void setReconnectGracePeriod(int seconds);
+void seedSecretGenerator(uint64_t seed);
+bool enablePlayerStats(const std::string &path);
+void disablePlayerStats();
+void recordGameResult(const GameResult &result);
+void addListenEndpoint(const ListenEndpoint &endpoint);
+bool enableAdminControl(const ListenEndpoint &endpoint);
+void disableAdminControl();
+void setIdleTimeout(int seconds);
+bool enableTrafficCapture(const std::string &path);
+void disableTrafficCapture();
+bool enableGameExport(const std::string &directory);
+void disableGameExport();
+void exportGameLog(GameSession &session);
 
 // Function to assign a client to an existing session or create a new one
-void assignClientToSession(int client_socket);
+void assignClientToSession(int client_socket, const GameVariant &variant);
 
 #endif // SERVER_H
@@ -0,0 +1,500 @@
+#include "simulation.h"
+#include <algorithm>
+
+const time_t SIMULATION_EPOCH = 1700000000;     // Wall-clock second the virtual clock starts at
+const int64_t LOBBY_PATIENCE_MS = 120000;       // A bot leaves the lobby after waiting this long
+
+// A code with a bit per digit it uses, so cows are a popcount
+struct BotCode {
+    char digits[5];
+    uint16_t mask;
+};
+
+// All 4-digit codes with unique digits, shared by every bot
+static const std::vector<BotCode> &allCodes()
+{
+    static std::vector<BotCode> codes;
+    if (codes.empty())
+    {
+        for (int value = 0; value < 10000; ++value)
+        {
+            std::string digits = std::to_string(value);
+            digits.insert(0, 4 - digits.size(), '0');
+            uint16_t mask = 0;
+            for (char digit : digits)
+            {
+                mask |= 1 << (digit - '0');
+            }
+            if (__builtin_popcount(mask) == 4)
+            {
+                BotCode code{};
+                digits.copy(code.digits, 4);
+                code.mask = mask;
+                codes.push_back(code);
+            }
+        }
+    }
+    return codes;
+}
+
+static std::pair<int, int> score(const BotCode &guess, const BotCode &secret)
+{
+    int bulls = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        bulls += guess.digits[i] == secret.digits[i];
+    }
+    return {bulls, __builtin_popcount(guess.mask & secret.mask) - bulls};
+}
+
+/* ------------------------------------------------------------ VIRTUAL CLOCK --------------------------------------------------------------------*/
+
+time_t VirtualClock::now()
+{
+    return SIMULATION_EPOCH + currentMs / 1000;
+}
+
+int64_t VirtualClock::nowMillis()
+{
+    return currentMs;
+}
+
+void VirtualClock::advanceTo(int64_t ms)
+{
+    currentMs = std::max(currentMs, ms);
+}
+
+/* ------------------------------------------------------------ TRANSPORT SIDE -------------------------------------------------------------------*/
+
+SimulatedNetwork::SimulatedNetwork(const SimulationConfig &config, VirtualClock &clock)
+    : config(config), clock(clock), rng(config.seed), bots(config.clients)
+{
+    for (int client = 0; client < config.clients; ++client)
+    {
+        bots[client].nickname = "bot" + std::to_string(client);
+        bots[client].gamesLeft = config.gamesPerClient;
+        int64_t connectAt = config.connectSpreadMs > 0 ? rng() % config.connectSpreadMs : 0;
+        schedule(connectAt, CONNECT, client, -1);
+    }
+}
+
+int SimulatedNetwork::accept(int listenSocket, std::string &peerAddress)
+{
+    if (listenSocket != LISTEN_SOCKET || pendingAccepts.empty())
+    {
+        return -1;
+    }
+
+    int client = pendingAccepts.front();
+    pendingAccepts.pop_front();
+    if (pendingAccepts.empty())
+    {
+        readable.erase(LISTEN_SOCKET);
+    }
+
+    int socket = nextSocket++;
+    sockets[socket].client = client;
+    bots[client].socket = socket;
+    bots[client].pending.clear();
+
+    // One address per bot so the per-address rate limit behaves like real traffic
+    peerAddress = "10." + std::to_string((client >> 16) & 255) + "." + std::to_string((client >> 8) & 255) + "." + std::to_string(client & 255);
+    return socket;
+}
+
+ssize_t SimulatedNetwork::receive(int socket, char *buffer, size_t length)
+{
+    auto it = sockets.find(socket);
+    if (it == sockets.end())
+    {
+        return -1;
+    }
+
+    VirtualSocket &virtualSocket = it->second;
+    if (virtualSocket.inbox.empty())
+    {
+        readable.erase(socket);
+        return virtualSocket.peerClosed ? 0 : -1;
+    }
+
+    // One scripted frame per read, truncated like a short recv would
+    std::string frame = std::move(virtualSocket.inbox.front());
+    virtualSocket.inbox.pop_front();
+    if (virtualSocket.inbox.empty() && !virtualSocket.peerClosed)
+    {
+        readable.erase(socket);
+    }
+
+    size_t size = std::min(length, frame.size());
+    std::copy(frame.begin(), frame.begin() + size, buffer);
+    stats.framesToServer++;
+    return size;
+}
+
+ssize_t SimulatedNetwork::send(int socket, const char *data, size_t length)
+{
+    auto it = sockets.find(socket);
+    if (it == sockets.end() || it->second.peerClosed)
+    {
+        return -1;
+    }
+
+    stats.framesFromServer++;
+    stats.bytesFromServer += length;
+    for (size_t i = 0; i < length; ++i)
+    {
+        stats.checksum = (stats.checksum ^ (unsigned char)data[i]) * 1099511628211ULL;
+    }
+
+    int client = it->second.client;
+    Bot &bot = bots[client];
+    bot.pending.append(data, length);
+
+    size_t newline;
+    while ((newline = bot.pending.find('\n')) != std::string::npos)
+    {
+        std::string line = bot.pending.substr(0, newline);
+        bot.pending.erase(0, newline + 1);
+        onServerLine(client, line);
+    }
+    return length;
+}
+
+void SimulatedNetwork::close(int socket)
+{
+    auto it = sockets.find(socket);
+    if (it == sockets.end())
+    {
+        return;
+    }
+
+    int client = it->second.client;
+    bool closedByServer = !it->second.peerClosed;
+    readable.erase(socket);
+    watched.erase(socket);
+    sockets.erase(it);
+
+    if (bots[client].socket == socket)
+    {
+        bots[client].socket = -1;
+    }
+    if (closedByServer)
+    {
+        stats.serverCloses++;
+        onServerClosed(client);
+    }
+}
+
+void SimulatedNetwork::watch(int socket)
+{
+    watched.insert(socket);
+}
+
+void SimulatedNetwork::unwatch(int socket)
+{
+    watched.erase(socket);
+}
+
+int SimulatedNetwork::wait(int64_t timeoutMs, std::vector<int> &readySockets)
+{
+    int64_t deadline = clock.nowMillis() + timeoutMs;
+
+    while (true)
+    {
+        readySockets.clear();
+        for (int socket : readable)
+        {
+            if (watched.count(socket))
+            {
+                readySockets.push_back(socket);
+            }
+        }
+        if (!readySockets.empty())
+        {
+            return readySockets.size();
+        }
+
+        // Stop once the script has run out and every connection is gone, or time is up
+        if ((events.empty() && sockets.empty()) || clock.nowMillis() >= config.maxVirtualMs)
+        {
+            return WAIT_SHUTDOWN;
+        }
+
+        // Nothing happens before the server's next timer, jump straight to it
+        if (events.empty() || events.top().atMs > deadline)
+        {
+            clock.advanceTo(deadline);
+            return 0;
+        }
+
+        Event event = events.top();
+        events.pop();
+        clock.advanceTo(event.atMs);
+        apply(event);
+    }
+}
+
+const SimulationStats &SimulatedNetwork::getStats() const
+{
+    return stats;
+}
+
+void SimulatedNetwork::schedule(int64_t delayMs, EventType type, int client, int socket, const std::string &payload)
+{
+    events.push(Event{clock.nowMillis() + delayMs, nextOrder++, type, client, socket, payload});
+}
+
+void SimulatedNetwork::apply(const Event &event)
+{
+    if (event.type == CONNECT)
+    {
+        stats.events++;
+        stats.connections++;
+        pendingAccepts.push_back(event.client);
+        markReadable(LISTEN_SOCKET);
+        return;
+    }
+
+    // Events of a connection that is gone by now are dropped
+    auto it = sockets.find(event.socket);
+    if (it == sockets.end() || it->second.peerClosed)
+    {
+        return;
+    }
+    stats.events++;
+
+    VirtualSocket &virtualSocket = it->second;
+    Bot &bot = bots[event.client];
+    switch (event.type)
+    {
+    case DATA:
+        virtualSocket.inbox.push_back(event.payload);
+        markReadable(event.socket);
+        break;
+    case PING:
+        if (bot.idle)
+        {
+            break; // A hung client stops its keep-alive too
+        }
+        if (!bot.inGame && bot.waitingSinceMs >= 0 && clock.nowMillis() - bot.waitingSinceMs > LOBBY_PATIENCE_MS)
+        {
+            bot.gamesLeft = 0; // Nobody to play with, give up
+            schedule(0, HANGUP, event.client, event.socket);
+            break;
+        }
+        virtualSocket.inbox.push_back("PING");
+        markReadable(event.socket);
+        schedule(config.pingIntervalMs, PING, event.client, event.socket);
+        break;
+    case HANGUP:
+        virtualSocket.peerClosed = true;
+        markReadable(event.socket);
+        bot.socket = -1;
+        break;
+    default:
+        break;
+    }
+}
+
+void SimulatedNetwork::markReadable(int socket)
+{
+    readable.insert(socket);
+}
+
+/* ------------------------------------------------------------ SCRIPTED BOTS --------------------------------------------------------------------*/
+
+void SimulatedNetwork::onServerLine(int client, const std::string &line)
+{
+    Bot &bot = bots[client];
+    int socket = bot.socket;
+
+    if (line == "SC")
+    {
+        bot.idle = false;
+        bot.nicknameAttempt = 0;
+        resetCandidates(bot);
+        sendNickname(client);
+        if (config.pingIntervalMs > 0)
+        {
+            schedule(config.pingIntervalMs, PING, client, socket);
+        }
+    }
+    else if (line == "NIU")
+    {
+        bot.nicknameAttempt++;
+        sendNickname(client);
+    }
+    else if (line == "NS")
+    {
+        bot.inGame = false;
+        bot.waitingSinceMs = clock.nowMillis();
+    }
+    else if (line == "SG")
+    {
+        bot.inGame = true;
+        bot.opponentGone = false;
+        resetCandidates(bot);
+    }
+    else if (line == "UT")
+    {
+        bot.inGame = true;
+        bot.opponentGone = false;
+        if (bot.idle)
+        {
+            return;
+        }
+        int64_t delay = thinkTime();
+        if (chance(config.dropChance))
+        {
+            // Drop the connection and come back later to reclaim the seat
+            stats.reconnects++;
+            schedule(delay, HANGUP, client, socket);
+            schedule(delay + config.reconnectDelayMs, CONNECT, client, -1);
+        }
+        else if (chance(config.idleChance))
+        {
+            bot.idle = true;
+        }
+        else
+        {
+            schedule(delay, DATA, client, socket, "G" + pickGuess(bot));
+        }
+    }
+    else if (line == "OT")
+    {
+        bot.inGame = true;
+        bot.opponentGone = false;
+        if (!bot.idle && chance(config.wrongTurnChance))
+        {
+            schedule(thinkTime(), DATA, client, socket, "G" + pickGuess(bot));
+        }
+    }
+    else if (line == "OD")
+    {
+        bot.opponentGone = true;
+    }
+    else if (line == "WIN")
+    {
+        stats.wins++;
+        if (bot.opponentGone)
+        {
+            stats.forfeits++;
+        }
+    }
+    else if (line == "EG")
+    {
+        bot.inGame = false;
+        bot.gamesLeft--;
+        resetCandidates(bot);
+        if (bot.gamesLeft > 0)
+        {
+            bot.nicknameAttempt = 0;
+            sendNickname(client);
+        }
+        else
+        {
+            schedule(thinkTime(), HANGUP, client, socket);
+        }
+    }
+    else if (!line.empty() && line[0] == 'G')
+    {
+        filterCandidates(bot, line);
+    }
+}
+
+void SimulatedNetwork::onServerClosed(int client)
+{
+    Bot &bot = bots[client];
+    bot.idle = false;
+    bot.inGame = false;
+    if (bot.gamesLeft > 0)
+    {
+        stats.reconnects++;
+        schedule(config.reconnectDelayMs, CONNECT, client, -1);
+    }
+}
+
+void SimulatedNetwork::sendNickname(int client)
+{
+    Bot &bot = bots[client];
+    std::string nickname = bot.nickname;
+    if (bot.nicknameAttempt > 0)
+    {
+        nickname += "_" + std::to_string(bot.nicknameAttempt);
+    }
+    schedule(thinkTime(), DATA, client, bot.socket, nickname);
+}
+
+void SimulatedNetwork::resetCandidates(Bot &bot)
+{
+    // Candidates are only materialised after the first answer, when few codes are left
+    std::vector<uint16_t>().swap(bot.candidates);
+    bot.narrowed = false;
+}
+
+void SimulatedNetwork::filterCandidates(Bot &bot, const std::string &answer)
+{
+    size_t b = answer.find('B');
+    size_t c = answer.find('C');
+    if (b != 5 || c == std::string::npos)
+    {
+        return;
+    }
+
+    BotCode guess{};
+    for (int i = 0; i < 4; ++i)
+    {
+        guess.digits[i] = answer[i + 1];
+        guess.mask |= 1 << ((answer[i + 1] - '0') & 15);
+    }
+    std::pair<int, int> expected = {std::stoi(answer.substr(b + 1, c - b - 1)), std::stoi(answer.substr(c + 1))};
+    const std::vector<BotCode> &codes = allCodes();
+
+    std::vector<uint16_t> remaining;
+    if (!bot.narrowed)
+    {
+        for (size_t i = 0; i < codes.size(); ++i)
+        {
+            if (score(guess, codes[i]) == expected)
+            {
+                remaining.push_back(i);
+            }
+        }
+        bot.narrowed = true;
+    }
+    else
+    {
+        for (uint16_t i : bot.candidates)
+        {
+            if (score(guess, codes[i]) == expected)
+            {
+                remaining.push_back(i);
+            }
+        }
+    }
+    bot.candidates.swap(remaining);
+}
+
+std::string SimulatedNetwork::pickGuess(Bot &bot)
+{
+    const std::vector<BotCode> &codes = allCodes();
+    if (!bot.narrowed || bot.candidates.empty())
+    {
+        return codes[rng() % codes.size()].digits;
+    }
+    return codes[bot.candidates[rng() % bot.candidates.size()]].digits;
+}
+
+int64_t SimulatedNetwork::thinkTime()
+{
+    if (config.thinkTimeMs <= 0)
+    {
+        return 0;
+    }
+    return config.thinkTimeMs / 2 + rng() % config.thinkTimeMs;
+}
+
+bool SimulatedNetwork::chance(double probability)
+{
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < probability;
+}
@@ -0,0 +1,136 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "transport.h"
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Knobs of a simulated run, everything else follows from the seed
+struct SimulationConfig {
+    int clients = 2000;              // Scripted players
+    int gamesPerClient = 5;          // Games each player plays before leaving
+    uint32_t seed = 1;               // Seeds both the bots and the server's secrets
+    int64_t thinkTimeMs = 800;       // Mean delay before a bot answers
+    int64_t pingIntervalMs = 3000;   // Keep-alive interval, 0 disables pings
+    int64_t connectSpreadMs = 60000; // Window over which players first connect
+    int64_t reconnectDelayMs = 5000; // Delay before a dropped bot comes back
+    double dropChance = 0.01;        // Chance to drop the connection instead of guessing
+    double idleChance = 0.002;       // Chance to stop answering until the server times out
+    double wrongTurnChance = 0.01;   // Chance to guess out of turn after the opponent's move
+    int reconnectGracePeriod = 60;   // Seconds the server holds a dropped player's seat
+    int64_t maxVirtualMs = 86400000; // Hard stop for the virtual clock
+};
+
+// Counters reported at the end of a run
+struct SimulationStats {
+    uint64_t events = 0;             // Scripted client events delivered to the server
+    uint64_t connections = 0;
+    uint64_t framesToServer = 0;
+    uint64_t framesFromServer = 0;
+    uint64_t bytesFromServer = 0;
+    uint64_t wins = 0;
+    uint64_t forfeits = 0;           // Wins handed out because the opponent never came back
+    uint64_t reconnects = 0;
+    uint64_t serverCloses = 0;       // Connections closed by the server
+    uint64_t checksum = 1469598103934665603ULL; // FNV-1a over everything the server sent
+};
+
+class VirtualClock : public Clock {
+public:
+    time_t now() override;
+    int64_t nowMillis() override;
+
+    void advanceTo(int64_t ms);
+
+private:
+    int64_t currentMs = 0;
+};
+
+// In-process transport: scripted bots on one side, the real server handlers on the other
+class SimulatedNetwork : public Transport {
+public:
+    static constexpr int LISTEN_SOCKET = 1;
+
+    SimulatedNetwork(const SimulationConfig &config, VirtualClock &clock);
+
+    int accept(int listenSocket, std::string &peerAddress) override;
+    ssize_t receive(int socket, char *buffer, size_t length) override;
+    ssize_t send(int socket, const char *data, size_t length) override;
+    void close(int socket) override;
+    void watch(int socket) override;
+    void unwatch(int socket) override;
+    int wait(int64_t timeoutMs, std::vector<int> &readySockets) override;
+
+    const SimulationStats &getStats() const;
+
+private:
+    enum EventType { CONNECT, DATA, PING, HANGUP };
+
+    struct Event {
+        int64_t atMs;
+        uint64_t order;     // Keeps events at the same millisecond in scheduling order
+        EventType type;
+        int client;
+        int socket;         // Socket the event belongs to, stale events are dropped
+        std::string payload;
+
+        bool operator>(const Event &other) const
+        {
+            return atMs != other.atMs ? atMs > other.atMs : order > other.order;
+        }
+    };
+
+    struct Bot {
+        int socket = -1;
+        std::string nickname;
+        int gamesLeft = 0;
+        int nicknameAttempt = 0;
+        bool inGame = false;
+        bool idle = false;
+        bool opponentGone = false;
+        int64_t waitingSinceMs = -1;        // When the bot entered the lobby
+        bool narrowed = false;              // Whether candidates holds anything yet
+        std::vector<uint16_t> candidates;   // Codes still consistent with every answer seen
+        std::string pending;                // Partial line from the server
+    };
+
+    struct VirtualSocket {
+        int client = -1;
+        bool peerClosed = false;
+        std::deque<std::string> inbox;      // Frames waiting for the server to read
+    };
+
+    void schedule(int64_t delayMs, EventType type, int client, int socket, const std::string &payload = "");
+    void apply(const Event &event);
+    void markReadable(int socket);
+    void onServerLine(int client, const std::string &line);
+    void onServerClosed(int client);
+    void sendNickname(int client);
+    void resetCandidates(Bot &bot);
+    void filterCandidates(Bot &bot, const std::string &answer);
+    std::string pickGuess(Bot &bot);
+    int64_t thinkTime();
+    bool chance(double probability);
+
+    SimulationConfig config;
+    VirtualClock &clock;
+    std::mt19937_64 rng;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    uint64_t nextOrder = 0;
+
+    std::vector<Bot> bots;
+    std::unordered_map<int, VirtualSocket> sockets;
+    std::deque<int> pendingAccepts;         // Clients waiting in the listen backlog
+    std::set<int> readable;                 // Ordered so readiness is reported deterministically
+    std::set<int> watched;
+    int nextSocket = LISTEN_SOCKET + 1;     // Virtual sockets are never reused
+    SimulationStats stats;
+};
+
+#endif // SIMULATION_H
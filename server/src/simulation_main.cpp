@@ -0,0 +1,122 @@
+#include "server.h"
+#include "simulation.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// Reads --name=value options into the simulation config
+static bool parseOption(const char *arg, SimulationConfig &config)
+{
+    const char *value = strchr(arg, '=');
+    if (value == nullptr)
+    {
+        return false;
+    }
+    std::string name(arg, value - arg);
+    value++;
+
+    try
+    {
+        if (name == "--clients") config.clients = std::stoi(value);
+        else if (name == "--games") config.gamesPerClient = std::stoi(value);
+        else if (name == "--seed") config.seed = std::stoul(value);
+        else if (name == "--think-ms") config.thinkTimeMs = std::stoll(value);
+        else if (name == "--ping-ms") config.pingIntervalMs = std::stoll(value);
+        else if (name == "--spread-ms") config.connectSpreadMs = std::stoll(value);
+        else if (name == "--reconnect-ms") config.reconnectDelayMs = std::stoll(value);
+        else if (name == "--drop") config.dropChance = std::stod(value);
+        else if (name == "--idle") config.idleChance = std::stod(value);
+        else if (name == "--wrong-turn") config.wrongTurnChance = std::stod(value);
+        else if (name == "--grace") config.reconnectGracePeriod = std::stoi(value);
+        else if (name == "--max-virtual-ms") config.maxVirtualMs = std::stoll(value);
+        else return false;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    SimulationConfig config;
+    std::string statsPath;
+    std::string exportDirectory;
+    std::string capturePath;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "--stats=", 8) == 0)
+        {
+            statsPath = argv[i] + 8;
+            continue;
+        }
+        if (strncmp(argv[i], "--export=", 9) == 0)
+        {
+            exportDirectory = argv[i] + 9;
+            continue;
+        }
+        if (strncmp(argv[i], "--capture=", 10) == 0)
+        {
+            capturePath = argv[i] + 10;
+            continue;
+        }
+        if (!parseOption(argv[i], config))
+        {
+            std::cerr << "[Simulation] Unknown option: " << argv[i] << "\n"
+                      << "Options: --clients= --games= --seed= --think-ms= --ping-ms= --spread-ms= --reconnect-ms=\n"
+                      << "         --drop= --idle= --wrong-turn= --grace= --max-virtual-ms= --stats=<file> --export=<dir> --capture=<file>\n";
+            return 1;
+        }
+    }
+
+    VirtualClock clock;
+    SimulatedNetwork network(config, clock);
+    setTransport(&network);
+    setClock(&clock);
+    seedSecretGenerator(config.seed);
+    setReconnectGracePeriod(config.reconnectGracePeriod);
+    setLogLevel(LOG_INFO);
+    if (!statsPath.empty())
+    {
+        enablePlayerStats(statsPath);
+    }
+    if (!exportDirectory.empty())
+    {
+        enableGameExport(exportDirectory);
+    }
+    if (!capturePath.empty())
+    {
+        enableTrafficCapture(capturePath);
+    }
+
+    std::cout << "[Simulation] " << config.clients << " clients x " << config.gamesPerClient << " games, seed " << config.seed << std::endl;
+
+    // The server logs every event, keep it quiet while measuring
+    std::streambuf *stdoutBuffer = std::cout.rdbuf(nullptr);
+    std::streambuf *stderrBuffer = std::cerr.rdbuf(nullptr);
+
+    auto started = std::chrono::steady_clock::now();
+    Server server;
+    server.serveOn(SimulatedNetwork::LISTEN_SOCKET);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    disablePlayerStats();
+    disableGameExport();
+    disableTrafficCapture();
+
+    std::cout.rdbuf(stdoutBuffer);
+    std::cout.clear();
+    std::cerr.rdbuf(stderrBuffer);
+    std::cerr.clear();
+
+    const SimulationStats &stats = network.getStats();
+    std::cout << "[Simulation] Virtual time:      " << clock.nowMillis() / 1000.0 << " s\n"
+              << "[Simulation] Wall time:         " << seconds << " s\n"
+              << "[Simulation] Client events:     " << stats.events << " (" << (uint64_t)(stats.events / std::max(seconds, 1e-9)) << " /s)\n"
+              << "[Simulation] Connections:       " << stats.connections << " (" << stats.reconnects << " reconnects, " << stats.serverCloses << " closed by server)\n"
+              << "[Simulation] Frames in/out:     " << stats.framesToServer << " / " << stats.framesFromServer << " (" << stats.bytesFromServer << " bytes out)\n"
+              << "[Simulation] Games won:         " << stats.wins << " (" << stats.forfeits << " by forfeit)\n"
+              << "[Simulation] Output checksum:   " << std::hex << stats.checksum << std::dec << "\n";
+    return 0;
+}
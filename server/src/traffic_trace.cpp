@@ -0,0 +1,138 @@
+#include "traffic_trace.h"
+#include <algorithm>
+#include <cstring>
+
+const char TRACE_MAGIC[] = "BCTRACE1";
+const size_t TRACE_BUFFER_SIZE = 1 << 20;   // Writes reach the disk in large chunks
+const uint64_t TRACE_MAX_PAYLOAD = 1 << 16;
+
+static size_t encodeVarint(uint64_t value, unsigned char *out)
+{
+    size_t size = 0;
+    while (value >= 0x80)
+    {
+        out[size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (unsigned char)value;
+    return size;
+}
+
+/* ------------------------------------------------------------ WRITER ---------------------------------------------------------------------------*/
+
+TraceWriter::~TraceWriter()
+{
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+}
+
+bool TraceWriter::open(const std::string &path)
+{
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    setvbuf(file, nullptr, _IOFBF, TRACE_BUFFER_SIZE);
+    fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC) - 1, file);
+    return true;
+}
+
+void TraceWriter::write(TraceRecordType type, int64_t atMs, uint64_t connection, const char *data, size_t size)
+{
+    // Header of at most 1 + 3 * 10 bytes, then the payload as it was received
+    unsigned char header[32];
+    size_t length = 0;
+    header[length++] = type;
+    length += encodeVarint(atMs >= previousMs ? atMs - previousMs : 0, header + length);
+    length += encodeVarint(connection, header + length);
+    if (type == TRACE_CONNECT || type == TRACE_FRAME)
+    {
+        length += encodeVarint(size, header + length);
+    }
+    previousMs = std::max(previousMs, atMs);
+
+    fwrite(header, 1, length, file);
+    if (size > 0)
+    {
+        fwrite(data, 1, size, file);
+    }
+    records++;
+}
+
+uint64_t TraceWriter::recordsWritten() const
+{
+    return records;
+}
+
+/* ------------------------------------------------------------ READER ---------------------------------------------------------------------------*/
+
+TraceReader::~TraceReader()
+{
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+}
+
+bool TraceReader::open(const std::string &path)
+{
+    file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    char magic[sizeof(TRACE_MAGIC) - 1];
+    return fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool TraceReader::readVarint(uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = fgetc(file);
+        if (byte == EOF)
+        {
+            return false;
+        }
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::next(TraceRecord &record)
+{
+    int type = fgetc(file);
+    uint64_t delta, connection;
+    if (type < TRACE_CONNECT || type > TRACE_CLOSED || !readVarint(delta) || !readVarint(connection))
+    {
+        return false;
+    }
+    currentMs += delta;
+    record.type = (TraceRecordType)type;
+    record.atMs = currentMs;
+    record.connection = connection;
+    record.payload.clear();
+
+    if (record.type == TRACE_CONNECT || record.type == TRACE_FRAME)
+    {
+        uint64_t size;
+        if (!readVarint(size) || size > TRACE_MAX_PAYLOAD)
+        {
+            return false;
+        }
+        record.payload.resize(size);
+        if (size > 0 && fread(&record.payload[0], 1, size, file) != size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef TRAFFIC_TRACE_H
+#define TRAFFIC_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Trace file: the magic "BCTRACE1", then records of
+//   type (1 byte), milliseconds since the previous record (varint), connection id (varint),
+//   and for CONNECT the peer address, for FRAME the bytes received (both varint length + bytes).
+enum TraceRecordType : uint8_t {
+    TRACE_CONNECT = 1,
+    TRACE_FRAME = 2,            // One recv on the server, i.e. one message as the server saw it
+    TRACE_PEER_CLOSED = 3,      // The client hung up or the connection failed, TRACE_CLOSED follows
+    TRACE_CLOSED = 4            // The server dropped the connection; on its own it was the server's decision
+};
+
+struct TraceRecord {
+    TraceRecordType type = TRACE_CONNECT;
+    int64_t atMs = 0;           // Server's monotonic clock when the record was captured
+    uint64_t connection = 0;    // Never reused within a trace, unlike sockets
+    std::string payload;        // Address or frame bytes
+};
+
+// Appends records from the game loop into a buffered file
+class TraceWriter {
+public:
+    ~TraceWriter();
+
+    bool open(const std::string &path);
+    void write(TraceRecordType type, int64_t atMs, uint64_t connection, const char *data = nullptr, size_t size = 0);
+    uint64_t recordsWritten() const;
+
+private:
+    FILE *file = nullptr;
+    int64_t previousMs = 0;
+    uint64_t records = 0;
+};
+
+class TraceReader {
+public:
+    ~TraceReader();
+
+    // False if the file is missing or not a trace
+    bool open(const std::string &path);
+
+    // False at the end of the trace or on a truncated record
+    bool next(TraceRecord &record);
+
+private:
+    bool readVarint(uint64_t &value);
+
+    FILE *file = nullptr;
+    int64_t currentMs = 0;
+};
+
+#endif // TRAFFIC_TRACE_H
@@ -0,0 +1,154 @@
+#include "transport.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------ POSIX TRANSPORT ------------------------------------------------------------------*/
+
+PosixTransport::PosixTransport()
+{
+    FD_ZERO(&master_set);
+}
+
+int PosixTransport::accept(int listenSocket, std::string &peerAddress)
+{
+    struct sockaddr_storage client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    int client_socket = ::accept(listenSocket, (struct sockaddr *)&client_addr, &client_len);
+
+    if (client_socket != -1)
+    {
+        // Set client socket to non-blocking
+        fcntl(client_socket, F_SETFL, O_NONBLOCK);
+
+        char addressBuffer[INET6_ADDRSTRLEN] = "";
+        PeerCredentials credentials;
+        if (client_addr.ss_family == AF_INET)
+        {
+            inet_ntop(AF_INET, &((struct sockaddr_in *)&client_addr)->sin_addr, addressBuffer, sizeof(addressBuffer));
+            peerAddress = addressBuffer;
+        }
+        else if (client_addr.ss_family == AF_INET6)
+        {
+            inet_ntop(AF_INET6, &((struct sockaddr_in6 *)&client_addr)->sin6_addr, addressBuffer, sizeof(addressBuffer));
+            peerAddress = addressBuffer;
+        }
+        else if (peerCredentials(client_socket, credentials))
+        {
+            // Local peers have no address, their user stands in for it
+            peerAddress = "unix:uid=" + std::to_string(credentials.uid);
+        }
+        else
+        {
+            peerAddress = "unix";
+        }
+    }
+    return client_socket;
+}
+
+ssize_t PosixTransport::receive(int socket, char *buffer, size_t length)
+{
+    return ::recv(socket, buffer, length, 0);
+}
+
+ssize_t PosixTransport::send(int socket, const char *data, size_t length)
+{
+    // A peer that already hung up must not take the whole server down with SIGPIPE
+    return ::send(socket, data, length, MSG_NOSIGNAL);
+}
+
+void PosixTransport::close(int socket)
+{
+    unwatch(socket);
+    ::close(socket);
+}
+
+bool PosixTransport::peerCredentials(int socket, PeerCredentials &credentials)
+{
+#ifdef SO_PEERCRED
+    struct ucred peer;
+    socklen_t length = sizeof(peer);
+    if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &peer, &length) == 0 && peer.pid != 0)
+    {
+        credentials.pid = peer.pid;
+        credentials.uid = peer.uid;
+        credentials.gid = peer.gid;
+        return true;
+    }
+#endif
+    return false;
+}
+
+void PosixTransport::enableKeepalive(int socket, const KeepaliveConfig &config)
+{
+    // Fails harmlessly on local sockets, whose peers cannot vanish silently
+    int enabled = 1;
+    if (setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, &enabled, sizeof(enabled)) != 0)
+    {
+        return;
+    }
+    setsockopt(socket, IPPROTO_TCP, TCP_KEEPIDLE, &config.idleSeconds, sizeof(config.idleSeconds));
+    setsockopt(socket, IPPROTO_TCP, TCP_KEEPINTVL, &config.intervalSeconds, sizeof(config.intervalSeconds));
+    setsockopt(socket, IPPROTO_TCP, TCP_KEEPCNT, &config.probes, sizeof(config.probes));
+#ifdef TCP_USER_TIMEOUT
+    unsigned int userTimeout = config.userTimeoutMs;
+    setsockopt(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, &userTimeout, sizeof(userTimeout));
+#endif
+}
+
+void PosixTransport::watch(int socket)
+{
+    FD_SET(socket, &master_set);
+    if (socket > fd_max)
+    {
+        fd_max = socket;
+    }
+}
+
+void PosixTransport::unwatch(int socket)
+{
+    FD_CLR(socket, &master_set);
+}
+
+int PosixTransport::wait(int64_t timeoutMs, std::vector<int> &readySockets)
+{
+    fd_set read_fds = master_set;
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    int activity = select(fd_max + 1, &read_fds, nullptr, nullptr, &timeout);
+    if (activity == -1)
+    {
+        return WAIT_FAILED;
+    }
+
+    readySockets.clear();
+    for (int i = 0; i <= fd_max && (int)readySockets.size() < activity; ++i)
+    {
+        if (FD_ISSET(i, &read_fds))
+        {
+            readySockets.push_back(i);
+        }
+    }
+    return activity;
+}
+
+/* ------------------------------------------------------------ SYSTEM CLOCK ---------------------------------------------------------------------*/
+
+time_t SystemClock::now()
+{
+    return time(nullptr);
+}
+
+int64_t SystemClock::nowMillis()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
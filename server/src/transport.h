@@ -0,0 +1,90 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <sys/select.h>
+#include <sys/types.h>
+#include <vector>
+
+// Return values of Transport::wait besides the number of ready sockets
+const int WAIT_FAILED = -1;     // The underlying poll failed
+const int WAIT_SHUTDOWN = -2;   // Nothing more will ever happen, leave the event loop
+
+// Identity of the process on the other end of a local socket
+struct PeerCredentials {
+    pid_t pid = 0;
+    uid_t uid = 0;
+    gid_t gid = 0;
+};
+
+// Kernel-side dead peer detection for TCP connections
+struct KeepaliveConfig {
+    int idleSeconds;        // Silence before the first probe
+    int intervalSeconds;    // Between unanswered probes
+    int probes;             // Unanswered probes before the connection is reset
+    int userTimeoutMs;      // Unacknowledged data older than this resets the connection
+};
+
+// Everything the server does with sockets, so the game logic can run on real or virtual connections
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    // Accepts a pending connection on the listening socket, -1 if there is none
+    virtual int accept(int listenSocket, std::string &peerAddress) = 0;
+    virtual ssize_t receive(int socket, char *buffer, size_t length) = 0;
+    virtual ssize_t send(int socket, const char *data, size_t length) = 0;
+    virtual void close(int socket) = 0;
+
+    // Credentials of the peer process, only known for local sockets
+    virtual bool peerCredentials(int, PeerCredentials &) { return false; }
+
+    // Lets the kernel probe an idle peer; a dead one then shows up as a read error
+    virtual void enableKeepalive(int, const KeepaliveConfig &) {}
+
+    // Sockets reported by wait when they become readable
+    virtual void watch(int socket) = 0;
+    virtual void unwatch(int socket) = 0;
+
+    // Waits up to timeoutMs for watched sockets to become readable and lists them in readySockets
+    virtual int wait(int64_t timeoutMs, std::vector<int> &readySockets) = 0;
+};
+
+// Source of time for timeouts and rate limits
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    virtual time_t now() = 0;           // Wall-clock seconds
+    virtual int64_t nowMillis() = 0;    // Monotonic milliseconds
+};
+
+// Plain POSIX sockets multiplexed with select
+class PosixTransport : public Transport {
+public:
+    PosixTransport();
+
+    int accept(int listenSocket, std::string &peerAddress) override;
+    ssize_t receive(int socket, char *buffer, size_t length) override;
+    ssize_t send(int socket, const char *data, size_t length) override;
+    void close(int socket) override;
+    bool peerCredentials(int socket, PeerCredentials &credentials) override;
+    void enableKeepalive(int socket, const KeepaliveConfig &config) override;
+    void watch(int socket) override;
+    void unwatch(int socket) override;
+    int wait(int64_t timeoutMs, std::vector<int> &readySockets) override;
+
+private:
+    fd_set master_set;
+    int fd_max = -1;
+};
+
+class SystemClock : public Clock {
+public:
+    time_t now() override;
+    int64_t nowMillis() override;
+};
+
+#endif // TRANSPORT_H